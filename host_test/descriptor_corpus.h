@@ -0,0 +1,68 @@
+/*
+ * HID Report Descriptor corpus for the host-side parser benchmark
+ *
+ * 语料来自本项目实际处理过的设备类型:
+ * - 16bit无线鼠标: test_parser.py中的真实descriptor(report id 2, 16位X/Y, AC Pan)
+ * - Boot鼠标: 经典4字节报告(无report id, 8位X/Y/Wheel)
+ * - Boot键盘: 标准8字节报告(修饰键位图 + 6键数组)
+ */
+
+#ifndef DESCRIPTOR_CORPUS_H__
+#define DESCRIPTOR_CORPUS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum
+{
+  CORPUS_MOUSE,
+  CORPUS_KEYBOARD,
+} corpus_kind_t;
+
+typedef struct
+{
+  const char *name;
+  corpus_kind_t kind;
+  const uint8_t *descriptor;
+  size_t descriptor_size;
+  size_t report_size;      // 输入报告字节数(含report id,如果有)
+  uint8_t report_id;       // 0表示无report id
+} corpus_entry_t;
+
+// 16bit无线鼠标(来自test_parser.py的真实抓取):
+// report id 2: 16按钮位图 + 16位X/Y + 8位Wheel + 8位AC Pan = 9字节(含id)
+static const uint8_t desc_mouse_16bit[] = {
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x02, 0x09, 0x01, 0xA1, 0x00, 0x05, 0x09, 0x19, 0x01,
+    0x29, 0x10, 0x15, 0x00, 0x25, 0x01, 0x95, 0x10, 0x75, 0x01, 0x81, 0x02, 0x05, 0x01, 0x16, 0x01,
+    0x80, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x02, 0x09, 0x30, 0x09, 0x31, 0x81, 0x06, 0x15, 0x81,
+    0x25, 0x7F, 0x75, 0x08, 0x95, 0x01, 0x09, 0x38, 0x81, 0x06, 0x05, 0x0C, 0x0A, 0x38, 0x02, 0x95,
+    0x01, 0x81, 0x06, 0xC0, 0xC0, 0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x03, 0x75, 0x10, 0x95,
+    0x02, 0x15, 0x01, 0x26, 0xFF, 0x02, 0x19, 0x01, 0x2A, 0xFF, 0x02, 0x81, 0x00, 0xC0, 0x05, 0x01,
+    0x09, 0x80, 0xA1, 0x01, 0x85, 0x04, 0x75, 0x02, 0x95, 0x01, 0x15, 0x01, 0x25, 0x03, 0x09, 0x82,
+    0x09, 0x81, 0x09, 0x83, 0x81, 0x60, 0x75, 0x06, 0x81, 0x03, 0xC0, 0x06, 0xBC, 0xFF, 0x09, 0x88,
+    0xA1, 0x01, 0x85, 0x08, 0x19, 0x01, 0x29, 0xFF, 0x15, 0x01, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95,
+    0x01, 0x81, 0x00, 0xC0};
+
+// 经典Boot鼠标: 3按钮 + 8位X/Y/Wheel, 无report id, 4字节报告
+static const uint8_t desc_mouse_boot[] = {
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x05, 0x09, 0x19, 0x01, 0x29, 0x03,
+    0x15, 0x00, 0x25, 0x01, 0x95, 0x03, 0x75, 0x01, 0x81, 0x02, 0x95, 0x01, 0x75, 0x05, 0x81, 0x03,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x09, 0x38, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x03,
+    0x81, 0x06, 0xC0, 0xC0};
+
+// 标准Boot键盘: 修饰键位图 + 保留 + LED输出 + 6键数组, 8字节报告
+static const uint8_t desc_keyboard_boot[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x05, 0x08, 0x19, 0x01,
+    0x29, 0x05, 0x75, 0x01, 0x95, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x05, 0x07,
+    0x19, 0x00, 0x29, 0x65, 0x15, 0x00, 0x25, 0x65, 0x75, 0x08, 0x95, 0x06, 0x81, 0x00, 0xC0};
+
+static const corpus_entry_t g_corpus[] = {
+    {"mouse_16bit_wireless", CORPUS_MOUSE, desc_mouse_16bit, sizeof(desc_mouse_16bit), 9, 2},
+    {"mouse_boot_8bit", CORPUS_MOUSE, desc_mouse_boot, sizeof(desc_mouse_boot), 4, 0},
+    {"keyboard_boot", CORPUS_KEYBOARD, desc_keyboard_boot, sizeof(desc_keyboard_boot), 8, 0},
+};
+
+#define CORPUS_COUNT (sizeof(g_corpus) / sizeof(g_corpus[0]))
+
+#endif /* DESCRIPTOR_CORPUS_H__ */
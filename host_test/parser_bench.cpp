@@ -0,0 +1,523 @@
+/*
+ * Host-side benchmark + cross-check for the HID report parser
+ *
+ * 测量内容(固件实际使用的C解析器):
+ * - descriptor解析耗时: parse_hid_report_descriptor_layouts + hid_report_plan_compile
+ * - 单报告字段提取吞吐: hid_field_extract_*(预编译plan,含8/16位快速路径)
+ * - 正确性交叉校验: plan提取结果必须与按layout位偏移逐位读取的参考实现
+ *   一致(不一致时以非零码退出,可直接挂在CI上)
+ *
+ * 注: main/hid_report_parser.h (hid::SelectiveInputReportParser)在本仓库中
+ * 只有声明没有实现TU,固件也未使用,因此这里只做编译检查(见
+ * cpp_header_compile.cpp),benchmark覆盖实际出货的C解析路径。
+ *
+ * 用法: parser_bench [--quick]   (--quick减少迭代次数,用于ctest)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "hid_report_parser_c.h"
+#include "descriptor_corpus.h"
+
+static double now_us()
+{
+  using namespace std::chrono;
+  return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() / 1000.0;
+}
+
+static int g_failures = 0;
+
+#define CHECK(cond, ...)                           \
+  do                                               \
+  {                                                \
+    if (!(cond))                                   \
+    {                                              \
+      printf("FAIL(%s:%d): ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                         \
+      printf("\n");                                \
+      g_failures++;                                \
+    }                                              \
+  } while (0)
+
+// 参考实现: 按位偏移逐位读取(LSB-first),与plan快速路径交叉校验
+static uint32_t ref_get_bits_u32(const uint8_t *data, int data_len, uint32_t bit_offset, uint32_t bit_size)
+{
+  uint32_t value = 0;
+  for (uint32_t i = 0; i < bit_size; i++)
+  {
+    uint32_t bit = bit_offset + i;
+    uint32_t byte_idx = bit / 8;
+    if ((int)byte_idx >= data_len)
+    {
+      break;
+    }
+    if (data[byte_idx] & (1u << (bit % 8)))
+    {
+      value |= (1u << i);
+    }
+  }
+  return value;
+}
+
+static int32_t ref_get_bits_s32(const uint8_t *data, int data_len, uint32_t bit_offset, uint32_t bit_size)
+{
+  uint32_t u = ref_get_bits_u32(data, data_len, bit_offset, bit_size);
+  if (bit_size > 0 && bit_size < 32 && (u & (1u << (bit_size - 1))))
+  {
+    return (int32_t)(u | (~0u << bit_size));
+  }
+  return (int32_t)u;
+}
+
+// 在C parser的多layout结果中找到与report_id匹配的layout
+static const hid_report_layout_t *find_layout(const hid_report_layout_t *layouts, int count, uint8_t report_id)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (layouts[i].report_id == report_id)
+    {
+      return &layouts[i];
+    }
+  }
+  return nullptr;
+}
+
+static void bench_mouse(const corpus_entry_t &entry, int desc_iters, int report_iters)
+{
+  printf("== %s (descriptor %zu bytes, report %zu bytes) ==\n",
+         entry.name, entry.descriptor_size, entry.report_size);
+
+  // ---- descriptor解析 + plan编译耗时 ----
+  hid_report_layout_t layouts[16];
+  hid_report_plan_t plan;
+  memset(&plan, 0, sizeof(plan));
+  int layout_count = 0;
+  double t0 = now_us();
+  for (int i = 0; i < desc_iters; i++)
+  {
+    layout_count = parse_hid_report_descriptor_layouts(entry.descriptor, entry.descriptor_size, layouts, 16);
+    const hid_report_layout_t *l = find_layout(layouts, layout_count, entry.report_id);
+    if (l != nullptr)
+    {
+      hid_report_plan_compile(l, &plan);
+    }
+  }
+  double c_parse_us = (now_us() - t0) / desc_iters;
+
+  const hid_report_layout_t *layout = find_layout(layouts, layout_count, entry.report_id);
+  CHECK(layout != nullptr, "%s: no layout for report_id=%u", entry.name, entry.report_id);
+  if (layout == nullptr)
+  {
+    return;
+  }
+  CHECK(layout->x_size > 0 && layout->y_size > 0, "%s: layout missing X/Y", entry.name);
+  CHECK(plan.min_length <= entry.report_size, "%s: plan.min_length=%u > report_size=%zu",
+        entry.name, plan.min_length, entry.report_size);
+
+  printf("  descriptor parse+compile: %8.3f us\n", c_parse_us);
+  printf("  layout (%s): buttons=%u@%u, x=%u@%u, y=%u@%u, wheel=%u@%u, pan=%u@%u | plan kinds: btn=%u x=%u y=%u wh=%u pan=%u\n",
+         hid_report_class_name((hid_report_class_t)plan.report_class),
+         layout->buttons_count, layout->buttons_bit_offset,
+         layout->x_size, layout->x_bit_offset,
+         layout->y_size, layout->y_bit_offset,
+         layout->wheel_size, layout->wheel_bit_offset,
+         layout->pan_size, layout->pan_bit_offset,
+         plan.buttons.kind, plan.x.kind, plan.y.kind, plan.wheel.kind, plan.pan.kind);
+  CHECK(plan.report_class == (uint8_t)hid_report_layout_classify(layout),
+        "%s: plan class != classify()", entry.name);
+
+  // 随机报告集(固定种子,保证可复现)
+  std::mt19937 rng(0x5EED);
+  std::vector<uint8_t> reports((size_t)report_iters * entry.report_size);
+  for (size_t i = 0; i < reports.size(); i++)
+  {
+    reports[i] = (uint8_t)rng();
+  }
+  if (entry.report_id != 0)
+  {
+    for (int i = 0; i < report_iters; i++)
+    {
+      reports[(size_t)i * entry.report_size] = entry.report_id;
+    }
+  }
+
+  // ---- 正确性交叉校验: plan提取 vs 参考逐位读取 ----
+  // layout的位偏移不含report_id字节,参考实现需要手动跳过
+  uint32_t id_adjust = (entry.report_id != 0) ? 8 : 0;
+  int check_count = report_iters < 10000 ? report_iters : 10000;
+  for (int i = 0; i < check_count; i++)
+  {
+    const uint8_t *rpt = &reports[(size_t)i * entry.report_size];
+    int len = (int)entry.report_size;
+
+    int32_t plan_dx = hid_field_extract_s32(&plan.x, rpt, len);
+    int32_t ref_dx = ref_get_bits_s32(rpt, len, layout->x_bit_offset + id_adjust, layout->x_size);
+    CHECK(plan_dx == ref_dx, "%s report %d: dx plan=%d ref=%d", entry.name, i, plan_dx, ref_dx);
+
+    int32_t plan_dy = hid_field_extract_s32(&plan.y, rpt, len);
+    int32_t ref_dy = ref_get_bits_s32(rpt, len, layout->y_bit_offset + id_adjust, layout->y_size);
+    CHECK(plan_dy == ref_dy, "%s report %d: dy plan=%d ref=%d", entry.name, i, plan_dy, ref_dy);
+
+    if (plan.wheel.kind != HID_FIELD_NONE)
+    {
+      int32_t plan_wh = hid_field_extract_s32(&plan.wheel, rpt, len);
+      int32_t ref_wh = ref_get_bits_s32(rpt, len, layout->wheel_bit_offset + id_adjust, layout->wheel_size);
+      CHECK(plan_wh == ref_wh, "%s report %d: wheel plan=%d ref=%d", entry.name, i, plan_wh, ref_wh);
+    }
+
+    if (plan.pan.kind != HID_FIELD_NONE)
+    {
+      int32_t plan_pan = hid_field_extract_s32(&plan.pan, rpt, len);
+      int32_t ref_pan = ref_get_bits_s32(rpt, len, layout->pan_bit_offset + id_adjust, layout->pan_size);
+      CHECK(plan_pan == ref_pan, "%s report %d: pan plan=%d ref=%d", entry.name, i, plan_pan, ref_pan);
+    }
+
+    uint32_t plan_btn = hid_field_extract_u32(&plan.buttons, rpt, len);
+    uint32_t ref_btn = ref_get_bits_u32(rpt, len, layout->buttons_bit_offset + id_adjust, layout->buttons_count);
+    CHECK(plan_btn == ref_btn, "%s report %d: buttons plan=0x%x ref=0x%x", entry.name, i, plan_btn, ref_btn);
+
+    if (g_failures > 10)
+    {
+      return; // 避免刷屏
+    }
+  }
+
+  // ---- 提取吞吐: plan快速路径 ----
+  volatile int64_t sink = 0;
+  t0 = now_us();
+  for (int i = 0; i < report_iters; i++)
+  {
+    const uint8_t *rpt = &reports[(size_t)i * entry.report_size];
+    int len = (int)entry.report_size;
+    sink += hid_field_extract_s32(&plan.x, rpt, len);
+    sink += hid_field_extract_s32(&plan.y, rpt, len);
+    sink += hid_field_extract_s32(&plan.wheel, rpt, len);
+    sink += hid_field_extract_u32(&plan.buttons, rpt, len);
+  }
+  double plan_total = now_us() - t0;
+
+  // ---- 提取吞吐: 参考逐位读取(对照基线) ----
+  t0 = now_us();
+  for (int i = 0; i < report_iters; i++)
+  {
+    const uint8_t *rpt = &reports[(size_t)i * entry.report_size];
+    int len = (int)entry.report_size;
+    sink += ref_get_bits_s32(rpt, len, layout->x_bit_offset + id_adjust, layout->x_size);
+    sink += ref_get_bits_s32(rpt, len, layout->y_bit_offset + id_adjust, layout->y_size);
+    sink += ref_get_bits_s32(rpt, len, layout->wheel_bit_offset + id_adjust, layout->wheel_size);
+    sink += ref_get_bits_u32(rpt, len, layout->buttons_bit_offset + id_adjust, layout->buttons_count);
+  }
+  double ref_total = now_us() - t0;
+  (void)sink;
+
+  printf("  report extract: plan = %6.1f ns/report (%7.2f Mrpt/s), bitwise ref = %6.1f ns/report (加速 %.1fx)\n",
+         plan_total * 1000.0 / report_iters, report_iters / plan_total,
+         ref_total * 1000.0 / report_iters, ref_total / plan_total);
+}
+
+static void bench_keyboard(const corpus_entry_t &entry, int desc_iters)
+{
+  printf("== %s (descriptor %zu bytes) ==\n", entry.name, entry.descriptor_size);
+
+  // 键盘descriptor不包含鼠标layout,解析器必须返回0个layout
+  // (固件据此走hid_device_type_detect的键盘分支)
+  hid_report_layout_t layouts[16];
+  int layout_count = 0;
+  double t0 = now_us();
+  for (int i = 0; i < desc_iters; i++)
+  {
+    layout_count = parse_hid_report_descriptor_layouts(entry.descriptor, entry.descriptor_size, layouts, 16);
+  }
+  double c_parse_us = (now_us() - t0) / desc_iters;
+
+  for (int i = 0; i < layout_count; i++)
+  {
+    CHECK(layouts[i].x_size == 0 || layouts[i].y_size == 0,
+          "%s: keyboard descriptor yielded mouse-like layout[%d]", entry.name, i);
+  }
+
+  printf("  descriptor parse: %8.3f us (%d non-mouse layouts, as expected)\n", c_parse_us, layout_count);
+}
+
+static void test_resolution_multiplier()
+{
+  // 合成descriptor: 典型的高分辨率滚轮声明
+  // (Logical 0..1 / Physical 1..4的multiplier feature + 8位wheel输入)
+  static const uint8_t desc[] = {
+      0x05, 0x01,       // Usage Page (Generic Desktop)
+      0x09, 0x02,       // Usage (Mouse)
+      0xA1, 0x01,       // Collection (Application)
+      0x85, 0x11,       //   Report ID (0x11)
+      0x09, 0x01,       //   Usage (Pointer)
+      0xA1, 0x00,       //   Collection (Physical)
+      0x05, 0x09,       //     Usage Page (Buttons)
+      0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01,
+      0x75, 0x01, 0x95, 0x03, 0x81, 0x02,
+      0x75, 0x05, 0x95, 0x01, 0x81, 0x01, // padding
+      0x05, 0x01, 0x09, 0x30, 0x09, 0x31,
+      0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02, 0x81, 0x06, // X/Y
+      0xA1, 0x02,       //     Collection (Logical)
+      0x09, 0x48,       //       Usage (Resolution Multiplier)
+      0x15, 0x00, 0x25, 0x01, //   Logical 0..1
+      0x35, 0x01, 0x45, 0x04, //   Physical 1..4
+      0x75, 0x02, 0x95, 0x01, //   2 bits
+      0xB1, 0x02,       //       Feature (Data,Var,Abs)
+      0x35, 0x00, 0x45, 0x00, //   Physical重置
+      0x09, 0x38,       //       Usage (Wheel)
+      0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x01,
+      0x81, 0x06,       //       Input (Data,Var,Rel)
+      0xC0,             //     End Collection
+      0xC0,             //   End Collection
+      0xC0,             // End Collection
+  };
+
+  hid_res_multiplier_t mult;
+  int r = parse_hid_resolution_multiplier(desc, sizeof(desc), &mult);
+  CHECK(r == 0, "resolution multiplier: not found in synthetic descriptor");
+  if (r != 0)
+  {
+    return;
+  }
+  CHECK(mult.report_id == 0x11, "resolution multiplier: report_id=%u expected 0x11", mult.report_id);
+  CHECK(mult.field_count == 1, "resolution multiplier: field_count=%u expected 1", mult.field_count);
+  CHECK(mult.bit_offsets[0] == 0 && mult.sizes[0] == 2,
+        "resolution multiplier: field bit=%u size=%u expected 0/2",
+        (unsigned)mult.bit_offsets[0], (unsigned)mult.sizes[0]);
+  CHECK(mult.logical_max == 1, "resolution multiplier: logical_max=%d expected 1", (int)mult.logical_max);
+  CHECK(mult.effective == 4, "resolution multiplier: effective=%d expected 4 (physical_max)", (int)mult.effective);
+
+  // multiplier不存在的descriptor必须返回-1(普通滚轮路径)
+  hid_res_multiplier_t none;
+  CHECK(parse_hid_resolution_multiplier(desc, 40, &none) != 0,
+        "resolution multiplier: truncated descriptor should not match");
+
+  printf("== resolution multiplier ==\n  report_id=0x%02x, %u field(s), effective=%d: OK\n\n",
+         mult.report_id, mult.field_count, (int)mult.effective);
+}
+
+static void test_report_id_classes()
+{
+  // 合成复合设备descriptor: 键盘(ID 1) + 媒体键Consumer(ID 2) + 鼠标(ID 3)
+  static const uint8_t desc[] = {
+      // Keyboard collection
+      0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x85, 0x01,
+      0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+      0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+      0x95, 0x06, 0x75, 0x08, 0x25, 0x65, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00,
+      0xC0,
+      // Consumer Control collection (媒体键挂在独立report_id后面)
+      0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x02,
+      0x19, 0x00, 0x2A, 0x3C, 0x02, 0x15, 0x00, 0x26, 0x3C, 0x02,
+      0x75, 0x10, 0x95, 0x01, 0x81, 0x00,
+      0xC0,
+      // Mouse collection
+      0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x03,
+      0x09, 0x01, 0xA1, 0x00,
+      0x05, 0x09, 0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01,
+      0x75, 0x01, 0x95, 0x03, 0x81, 0x02,
+      0x75, 0x05, 0x95, 0x01, 0x81, 0x01,
+      0x05, 0x01, 0x09, 0x30, 0x09, 0x31,
+      0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02, 0x81, 0x06,
+      0xC0, 0xC0,
+  };
+
+  hid_report_id_entry_t entries[HID_REPORT_ID_CLASS_MAX];
+  int n = parse_hid_report_id_classes(desc, sizeof(desc), entries, HID_REPORT_ID_CLASS_MAX);
+  CHECK(n == 3, "report id classes: count=%d expected 3", n);
+
+  for (int i = 0; i < n; i++)
+  {
+    switch (entries[i].report_id)
+    {
+    case 1:
+      CHECK(entries[i].rid_class == HID_RID_CLASS_KEYBOARD,
+            "report id classes: id=1 class=%u expected keyboard", entries[i].rid_class);
+      break;
+    case 2:
+      CHECK(entries[i].rid_class == HID_RID_CLASS_CONSUMER,
+            "report id classes: id=2 class=%u expected consumer", entries[i].rid_class);
+      break;
+    case 3:
+      CHECK(entries[i].rid_class == HID_RID_CLASS_MOUSE,
+            "report id classes: id=3 class=%u expected mouse", entries[i].rid_class);
+      break;
+    default:
+      CHECK(false, "report id classes: unexpected report_id=%u", entries[i].report_id);
+      break;
+    }
+  }
+
+  printf("== report id classes ==\n  %d input report id(s) classified: OK\n\n", n);
+}
+
+static void test_gamepad_layout()
+{
+  // 合成手柄descriptor: ID 4, X/Y有符号8位, Z/Rz无符号8位,
+  // 帽开关4位(1..8)+4位padding, 16按钮
+  static const uint8_t desc[] = {
+      0x05, 0x01,       // Usage Page (Generic Desktop)
+      0x09, 0x05,       // Usage (Game Pad)
+      0xA1, 0x01,       // Collection (Application)
+      0x85, 0x04,       //   Report ID (4)
+      0x09, 0x01,       //   Usage (Pointer)
+      0xA1, 0x00,       //   Collection (Physical)
+      0x09, 0x30, 0x09, 0x31, // Usage X/Y
+      0x15, 0x81, 0x25, 0x7F, // Logical -127..127
+      0x75, 0x08, 0x95, 0x02, 0x81, 0x02,
+      0xC0,             //   End Collection
+      0x09, 0x32, 0x09, 0x35, // Usage Z/Rz (触发器)
+      0x15, 0x00, 0x26, 0xFF, 0x00, // Logical 0..255
+      0x75, 0x08, 0x95, 0x02, 0x81, 0x02,
+      0x09, 0x39,       //   Usage (Hat Switch)
+      0x15, 0x01, 0x25, 0x08, // Logical 1..8
+      0x75, 0x04, 0x95, 0x01, 0x81, 0x42, // Input (Var,Null)
+      0x75, 0x04, 0x95, 0x01, 0x81, 0x01, // padding
+      0x05, 0x09,       //   Usage Page (Buttons)
+      0x19, 0x01, 0x29, 0x10, 0x15, 0x00, 0x25, 0x01,
+      0x75, 0x01, 0x95, 0x10, 0x81, 0x02,
+      0xC0,             // End Collection
+  };
+
+  hid_gamepad_layout_t layout;
+  int r = parse_hid_gamepad_layout(desc, sizeof(desc), &layout);
+  CHECK(r == 0, "gamepad layout: not found in synthetic descriptor");
+  if (r != 0)
+  {
+    return;
+  }
+  CHECK(layout.report_id == 4, "gamepad layout: report_id=%u expected 4", layout.report_id);
+  CHECK(layout.axes[0].size == 8 && layout.axes[0].bit_offset == 0 && layout.axes[0].logical_min == -127,
+        "gamepad layout: X bit=%u size=%u min=%d expected 0/8/-127",
+        (unsigned)layout.axes[0].bit_offset, (unsigned)layout.axes[0].size, (int)layout.axes[0].logical_min);
+  CHECK(layout.axes[1].bit_offset == 8, "gamepad layout: Y bit=%u expected 8", (unsigned)layout.axes[1].bit_offset);
+  CHECK(layout.axes[2].bit_offset == 16 && layout.axes[2].logical_min == 0 && layout.axes[2].logical_max == 255,
+        "gamepad layout: Z bit=%u min=%d max=%d expected 16/0/255",
+        (unsigned)layout.axes[2].bit_offset, (int)layout.axes[2].logical_min, (int)layout.axes[2].logical_max);
+  CHECK(layout.axes[3].bit_offset == 24, "gamepad layout: Rz bit=%u expected 24", (unsigned)layout.axes[3].bit_offset);
+  CHECK(layout.axes[4].size == 0 && layout.axes[5].size == 0,
+        "gamepad layout: Rx/Ry should be absent (size %u/%u)",
+        (unsigned)layout.axes[4].size, (unsigned)layout.axes[5].size);
+  CHECK(layout.hat.bit_offset == 32 && layout.hat.size == 4 && layout.hat.logical_min == 1,
+        "gamepad layout: hat bit=%u size=%u min=%d expected 32/4/1",
+        (unsigned)layout.hat.bit_offset, (unsigned)layout.hat.size, (int)layout.hat.logical_min);
+  CHECK(layout.buttons_count == 16 && layout.buttons_bit_offset == 40,
+        "gamepad layout: buttons count=%u bit=%u expected 16/40",
+        (unsigned)layout.buttons_count, (unsigned)layout.buttons_bit_offset);
+  CHECK(layout.report_size_bits == 56, "gamepad layout: total=%u bits expected 56",
+        (unsigned)layout.report_size_bits);
+
+  hid_gamepad_plan_t plan;
+  hid_gamepad_plan_compile(&layout, &plan);
+  CHECK(plan.min_length == 8, "gamepad plan: min_length=%u expected 8 (7数据+report_id)", plan.min_length);
+  CHECK(plan.axis_center[0] == 0, "gamepad plan: signed X center=%d expected 0", (int)plan.axis_center[0]);
+  CHECK(plan.axis_center[2] == 128, "gamepad plan: unsigned Z center=%d expected 128", (int)plan.axis_center[2]);
+  CHECK(plan.hat_min == 1, "gamepad plan: hat_min=%d expected 1", (int)plan.hat_min);
+
+  // 合成报告交叉验证: X=-50, Y=100, Z=200, Rz=0, hat=3(东), 按钮1+9按下
+  const uint8_t report[] = {0x04, (uint8_t)(int8_t)-50, 100, 200, 0, 0x03, 0x01, 0x01};
+  int32_t x = hid_field_extract_s32(&plan.axes[0], report, sizeof(report));
+  int32_t z = hid_field_extract_s32(&plan.axes[2], report, sizeof(report));
+  uint32_t hat = hid_field_extract_u32(&plan.hat, report, sizeof(report));
+  uint32_t buttons = hid_field_extract_u32(&plan.buttons, report, sizeof(report));
+  CHECK(x == -50, "gamepad extract: X=%d expected -50", (int)x);
+  CHECK(((z - plan.axis_center[2]) >> plan.axis_downshift[2]) == 72,
+        "gamepad extract: Z centered=%d expected 72", (int)((z - plan.axis_center[2]) >> plan.axis_downshift[2]));
+  CHECK(hat == 3, "gamepad extract: hat=%u expected 3", (unsigned)hat);
+  CHECK(buttons == 0x0101, "gamepad extract: buttons=0x%x expected 0x0101", (unsigned)buttons);
+
+  printf("== gamepad layout ==\n  report_id=%u, %u bits, 16 buttons, extraction cross-check: OK\n\n",
+         layout.report_id, (unsigned)layout.report_size_bits);
+}
+
+static void test_consumer_layout()
+{
+  // 合成媒体键descriptor: ID 2, 3位usage位图+5位padding + 16位usage数组
+  static const uint8_t desc[] = {
+      0x05, 0x0C,       // Usage Page (Consumer Devices)
+      0x09, 0x01,       // Usage (Consumer Control)
+      0xA1, 0x01,       // Collection (Application)
+      0x85, 0x02,       //   Report ID (2)
+      0x09, 0xCD,       //   Usage (Play/Pause)
+      0x09, 0xB5,       //   Usage (Scan Next)
+      0x09, 0xB6,       //   Usage (Scan Prev)
+      0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x03, 0x81, 0x02,
+      0x75, 0x05, 0x95, 0x01, 0x81, 0x01, // padding
+      0x19, 0x00,       //   Usage Min (0)
+      0x2A, 0xFF, 0x02, //   Usage Max (0x2FF)
+      0x15, 0x00, 0x26, 0xFF, 0x02,
+      0x75, 0x10, 0x95, 0x01, 0x81, 0x00, // 16-bit array
+      0xC0,             // End Collection
+  };
+
+  hid_consumer_layout_t layout;
+  int r = parse_hid_consumer_layout(desc, sizeof(desc), &layout);
+  CHECK(r == 0, "consumer layout: not found in synthetic descriptor");
+  if (r != 0)
+  {
+    return;
+  }
+  CHECK(layout.report_id == 2, "consumer layout: report_id=%u expected 2", layout.report_id);
+  CHECK(layout.bit_count == 3, "consumer layout: bit_count=%u expected 3", layout.bit_count);
+  CHECK(layout.bits[0].usage == 0xCD && layout.bits[1].usage == 0xB5 && layout.bits[2].usage == 0xB6,
+        "consumer layout: bitmap usages 0x%x/0x%x/0x%x expected CD/B5/B6",
+        layout.bits[0].usage, layout.bits[1].usage, layout.bits[2].usage);
+  CHECK(layout.array_count == 1, "consumer layout: array_count=%u expected 1", layout.array_count);
+  CHECK(layout.arrays[0].usage_min == 0 && layout.arrays[0].usage_max == 0x2FF,
+        "consumer layout: array usage range 0x%x..0x%x expected 0..0x2FF",
+        layout.arrays[0].usage_min, layout.arrays[0].usage_max);
+  CHECK(layout.min_length == 4, "consumer layout: min_length=%u expected 4 (3数据+report_id)",
+        layout.min_length);
+
+  // 合成报告交叉验证: 位图第1位(Scan Next)按下, 数组槽为0x01B7
+  const uint8_t report[] = {0x02, 0x02, 0xB7, 0x01};
+  CHECK(hid_field_extract_u32(&layout.bits[0].field, report, sizeof(report)) == 0,
+        "consumer extract: bit0 should be clear");
+  CHECK(hid_field_extract_u32(&layout.bits[1].field, report, sizeof(report)) == 1,
+        "consumer extract: bit1 should be set");
+  uint32_t slot = hid_field_extract_u32(&layout.arrays[0].field, report, sizeof(report));
+  CHECK(slot == 0x01B7, "consumer extract: array slot=0x%x expected 0x1B7", (unsigned)slot);
+
+  printf("== consumer layout ==\n  report_id=%u, %u bitmap bit(s) + %u array slot(s): OK\n\n",
+         layout.report_id, layout.bit_count, layout.array_count);
+}
+
+int main(int argc, char **argv)
+{
+  bool quick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+  int desc_iters = quick ? 200 : 10000;
+  int report_iters = quick ? 20000 : 2000000;
+
+  printf("hid_report_parser host benchmark (%s: %d descriptor iters, %d report iters)\n\n",
+         quick ? "quick" : "full", desc_iters, report_iters);
+
+  for (size_t i = 0; i < CORPUS_COUNT; i++)
+  {
+    if (g_corpus[i].kind == CORPUS_MOUSE)
+    {
+      bench_mouse(g_corpus[i], desc_iters, report_iters);
+    }
+    else
+    {
+      bench_keyboard(g_corpus[i], desc_iters);
+    }
+    printf("\n");
+  }
+
+  test_resolution_multiplier();
+  test_report_id_classes();
+  test_gamepad_layout();
+  test_consumer_layout();
+
+  if (g_failures)
+  {
+    printf("RESULT: %d check(s) FAILED\n", g_failures);
+    return 1;
+  }
+  printf("RESULT: all cross-checks passed\n");
+  return 0;
+}
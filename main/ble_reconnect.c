@@ -0,0 +1,346 @@
+/*
+ * BLE Fast Reconnect Engine - Implementation File
+ *
+ * 背景: 每次断开都退回普通无定向广播,主机从睡眠恢复要走完整的
+ * 扫描/连接/加密周期,键盘"死"好几秒。定向广播直接点名绑定主机,
+ * 主机监听到自己的地址立即发CONNECT_IND,重连时间降到百毫秒级。
+ */
+
+#include "ble_reconnect.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include <string.h>
+
+static const char *TAG = "BLE_RCN";
+
+// NVS存储
+#define RCN_NVS_NAMESPACE "ble_rcn"
+#define RCN_NVS_KEY "hosts"
+#define RCN_MAGIC 0x52434E31 // "RCN1"
+
+/* =================================================================================================
+   内部状态
+   ================================================================================================= */
+
+// 单个绑定主机槽位
+typedef struct
+{
+  esp_bd_addr_t bda;
+  uint8_t addr_type; // esp_ble_addr_type_t
+  bool valid;
+} bonded_host_t;
+
+// 绑定表(NVS blob整体读写)
+typedef struct
+{
+  uint32_t magic;
+  int8_t last_slot; // 最近连接的槽位(-1表示无)
+  bonded_host_t hosts[BLE_RECONNECT_MAX_HOSTS];
+} bonded_table_t;
+
+// 广播状态机
+typedef enum
+{
+  RCN_STATE_IDLE = 0,
+  RCN_STATE_ADV_DIRECTED,   // 定向广播中(等连接或超时)
+  RCN_STATE_ADV_UNDIRECTED, // 无定向广播中
+  RCN_STATE_CONNECTED,
+} rcn_state_t;
+
+static bonded_table_t s_table = {.magic = RCN_MAGIC, .last_slot = -1};
+static rcn_state_t s_state = RCN_STATE_IDLE;
+static bool s_nvs_ok = false;
+static bool s_fallback_pending = false; // 等ADV_STOP后拉起无定向广播
+
+static esp_ble_adv_params_t *s_undirected_params = NULL;
+static esp_timer_handle_t s_fallback_timer = NULL;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+/**
+ * @brief 把绑定表写回NVS(失败只记日志,功能降级)
+ */
+static void table_save(void)
+{
+  if (!s_nvs_ok)
+  {
+    return;
+  }
+  nvs_handle_t handle;
+  esp_err_t ret = nvs_open(RCN_NVS_NAMESPACE, NVS_READWRITE, &handle);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG, "打开NVS失败: %s", esp_err_to_name(ret));
+    return;
+  }
+  ret = nvs_set_blob(handle, RCN_NVS_KEY, &s_table, sizeof(s_table));
+  if (ret == ESP_OK)
+  {
+    nvs_commit(handle);
+  }
+  else
+  {
+    ESP_LOGW(TAG, "写入绑定表失败: %s", esp_err_to_name(ret));
+  }
+  nvs_close(handle);
+}
+
+/**
+ * @brief 查找地址对应的槽位(-1表示不存在)
+ */
+static int table_find(const uint8_t *bda)
+{
+  for (int i = 0; i < BLE_RECONNECT_MAX_HOSTS; i++)
+  {
+    if (s_table.hosts[i].valid && memcmp(s_table.hosts[i].bda, bda, ESP_BD_ADDR_LEN) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief 朝指定槽位的主机发起高占空比定向广播
+ *
+ * @return true 已发起
+ */
+static bool start_directed_adv(int slot)
+{
+  if (slot < 0 || slot >= BLE_RECONNECT_MAX_HOSTS || !s_table.hosts[slot].valid)
+  {
+    return false;
+  }
+
+  esp_ble_adv_params_t params = {
+      .adv_int_min = 0x20,
+      .adv_int_max = 0x30,
+      .adv_type = ADV_TYPE_DIRECT_IND_HIGH,
+      .own_addr_type = BLE_ADDR_TYPE_PUBLIC,
+      .peer_addr_type = (esp_ble_addr_type_t)s_table.hosts[slot].addr_type,
+      .channel_map = ADV_CHNL_ALL,
+      .adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY,
+  };
+  memcpy(params.peer_addr, s_table.hosts[slot].bda, ESP_BD_ADDR_LEN);
+
+  esp_err_t ret = esp_ble_gap_start_advertising(&params);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG, "定向广播启动失败: %s", esp_err_to_name(ret));
+    return false;
+  }
+
+  s_state = RCN_STATE_ADV_DIRECTED;
+  // 超时回退: 高占空比定向广播受控制器1.28s限制,主机不在就换无定向
+  if (s_fallback_timer != NULL)
+  {
+    esp_timer_stop(s_fallback_timer);
+    esp_timer_start_once(s_fallback_timer, (uint64_t)BLE_RECONNECT_DIRECTED_TIMEOUT_MS * 1000);
+  }
+  ESP_LOGI(TAG, "定向广播已启动: 槽位%d, 地址%02x:%02x:%02x:%02x:%02x:%02x",
+           slot,
+           s_table.hosts[slot].bda[0], s_table.hosts[slot].bda[1], s_table.hosts[slot].bda[2],
+           s_table.hosts[slot].bda[3], s_table.hosts[slot].bda[4], s_table.hosts[slot].bda[5]);
+  return true;
+}
+
+/**
+ * @brief 启动无定向广播(回退路径)
+ */
+static void start_undirected_adv(void)
+{
+  if (s_undirected_params == NULL)
+  {
+    return;
+  }
+  esp_err_t ret = esp_ble_gap_start_advertising(s_undirected_params);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG, "无定向广播启动失败: %s", esp_err_to_name(ret));
+    return;
+  }
+  s_state = RCN_STATE_ADV_UNDIRECTED;
+  ESP_LOGI(TAG, "无定向广播已启动");
+}
+
+/**
+ * @brief 定向广播回退定时器: 停掉定向广播,转无定向
+ *
+ * 停止完成事件(ADV_STOP_COMPLETE)里再拉起无定向广播,
+ * 避免和GAP命令队列打架
+ */
+static void fallback_timer_callback(void *arg)
+{
+  if (s_state != RCN_STATE_ADV_DIRECTED)
+  {
+    return;
+  }
+  ESP_LOGI(TAG, "定向广播超时(主机不在?),回退到无定向广播");
+  s_fallback_pending = true;
+  esp_err_t ret = esp_ble_gap_stop_advertising();
+  if (ret != ESP_OK)
+  {
+    // 控制器可能已经因1.28s限制自己停了,直接拉起无定向广播
+    s_fallback_pending = false;
+    start_undirected_adv();
+  }
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+esp_err_t ble_reconnect_init(esp_ble_adv_params_t *undirected_params)
+{
+  s_undirected_params = undirected_params;
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = &fallback_timer_callback,
+      .arg = NULL,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "rcn_fallback"};
+  esp_err_t ret = esp_timer_create(&timer_args, &s_fallback_timer);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGE(TAG, "创建回退定时器失败: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  // 从NVS加载绑定表
+  nvs_handle_t handle;
+  ret = nvs_open(RCN_NVS_NAMESPACE, NVS_READWRITE, &handle);
+  if (ret == ESP_OK)
+  {
+    s_nvs_ok = true;
+    size_t size = sizeof(s_table);
+    bonded_table_t loaded;
+    ret = nvs_get_blob(handle, RCN_NVS_KEY, &loaded, &size);
+    if (ret == ESP_OK && size == sizeof(loaded) && loaded.magic == RCN_MAGIC)
+    {
+      s_table = loaded;
+      int count = 0;
+      for (int i = 0; i < BLE_RECONNECT_MAX_HOSTS; i++)
+      {
+        if (s_table.hosts[i].valid)
+        {
+          count++;
+        }
+      }
+      ESP_LOGI(TAG, "绑定表已加载: %d个主机, 最近槽位%d", count, s_table.last_slot);
+    }
+    nvs_close(handle);
+  }
+  else
+  {
+    ESP_LOGW(TAG, "NVS不可用(%s),绑定表不持久化", esp_err_to_name(ret));
+  }
+
+  return ESP_OK;
+}
+
+void ble_reconnect_start_advertising(void)
+{
+  // 有最近主机就先定向,否则直接无定向
+  if (s_table.last_slot >= 0 && start_directed_adv(s_table.last_slot))
+  {
+    return;
+  }
+  start_undirected_adv();
+}
+
+void ble_reconnect_on_auth_complete(esp_bd_addr_t bda, esp_ble_addr_type_t addr_type)
+{
+  int slot = table_find(bda);
+  if (slot < 0)
+  {
+    // 找空槽,没有就覆盖最老的(非last)槽位
+    for (int i = 0; i < BLE_RECONNECT_MAX_HOSTS; i++)
+    {
+      if (!s_table.hosts[i].valid)
+      {
+        slot = i;
+        break;
+      }
+    }
+    if (slot < 0)
+    {
+      slot = (s_table.last_slot + 1) % BLE_RECONNECT_MAX_HOSTS;
+    }
+    memcpy(s_table.hosts[slot].bda, bda, ESP_BD_ADDR_LEN);
+    s_table.hosts[slot].addr_type = (uint8_t)addr_type;
+    s_table.hosts[slot].valid = true;
+    ESP_LOGI(TAG, "新主机写入绑定表: 槽位%d", slot);
+  }
+
+  s_state = RCN_STATE_CONNECTED;
+  if (s_table.last_slot != slot)
+  {
+    s_table.last_slot = (int8_t)slot;
+  }
+  table_save();
+}
+
+void ble_reconnect_on_connected(void)
+{
+  s_state = RCN_STATE_CONNECTED;
+  s_fallback_pending = false;
+  if (s_fallback_timer != NULL)
+  {
+    esp_timer_stop(s_fallback_timer);
+  }
+}
+
+void ble_reconnect_on_adv_stopped(void)
+{
+  if (s_fallback_pending)
+  {
+    s_fallback_pending = false;
+    start_undirected_adv();
+  }
+}
+
+bool ble_reconnect_switch_to_slot(int slot)
+{
+  if (slot < 0 || slot >= BLE_RECONNECT_MAX_HOSTS || !s_table.hosts[slot].valid)
+  {
+    ESP_LOGW(TAG, "切换失败: 槽位%d为空", slot);
+    return false;
+  }
+  if (s_state == RCN_STATE_CONNECTED && slot == s_table.last_slot)
+  {
+    ESP_LOGI(TAG, "已经连接在槽位%d,忽略切换", slot);
+    return false;
+  }
+
+  ESP_LOGI(TAG, "热键切换到主机槽位%d", slot);
+  int prev_slot = s_table.last_slot;
+  s_table.last_slot = (int8_t)slot;
+  table_save();
+
+  if (s_state == RCN_STATE_CONNECTED && prev_slot >= 0)
+  {
+    // 断开当前连接;断开事件会触发ble_reconnect_start_advertising,
+    // 此时last_slot已指向目标主机,自然走定向广播
+    esp_ble_gap_disconnect(s_table.hosts[prev_slot].bda);
+  }
+  else
+  {
+    // 未连接: 直接换定向广播目标
+    if (s_state == RCN_STATE_ADV_DIRECTED || s_state == RCN_STATE_ADV_UNDIRECTED)
+    {
+      s_fallback_pending = false;
+      esp_ble_gap_stop_advertising();
+    }
+    start_directed_adv(slot);
+  }
+  return true;
+}
+
+int ble_reconnect_get_active_slot(void)
+{
+  return s_table.last_slot;
+}
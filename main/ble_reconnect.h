@@ -0,0 +1,86 @@
+/*
+ * BLE Fast Reconnect Engine - Header File
+ *
+ * 核心思想:
+ * - 配对成功的主机(地址+类型)记入NVS绑定表,掉电不丢
+ * - 断开后先朝最近连接的主机做定向广播,免去整个扫描/连接周期,
+ *   超时(主机不在)再回退到普通无定向广播
+ * - 绑定表最多4个槽位,键盘热键Ctrl+Alt+F1..F4在主机间切换
+ *   (商用多设备键盘的交互习惯)
+ */
+
+#ifndef BLE_RECONNECT_H__
+#define BLE_RECONNECT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_gap_ble_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 绑定主机槽位数(热键F1..F4)
+#define BLE_RECONNECT_MAX_HOSTS 4
+
+// 定向广播超时(毫秒): 超时后回退到无定向广播
+// 高占空比定向广播本身受控制器1.28s限制,这里留一点余量
+#define BLE_RECONNECT_DIRECTED_TIMEOUT_MS 1500
+
+  /**
+   * @brief 初始化重连引擎(从NVS加载绑定表)
+   *
+   * @param undirected_params 无定向广播参数(回退用,调用方持有)
+   * @return ESP_OK 成功(NVS不可用时降级为只用无定向广播)
+   */
+  esp_err_t ble_reconnect_init(esp_ble_adv_params_t *undirected_params);
+
+  /**
+   * @brief 启动广播: 有绑定主机时定向,否则无定向
+   *
+   * 替代直接调用esp_ble_gap_start_advertising的位置
+   * (广播数据配置完成事件和断开事件)
+   */
+  void ble_reconnect_start_advertising(void);
+
+  /**
+   * @brief 配对/加密完成时调用: 把主机写入绑定表并设为最近主机
+   *
+   * @param bda 主机地址(AUTH_CMPL里的已解析地址)
+   * @param addr_type 地址类型
+   */
+  void ble_reconnect_on_auth_complete(esp_bd_addr_t bda, esp_ble_addr_type_t addr_type);
+
+  /**
+   * @brief 连接建立时调用: 取消定向广播回退定时器
+   */
+  void ble_reconnect_on_connected(void);
+
+  /**
+   * @brief 广播停止完成事件时调用: 处于回退流程时接着拉起无定向广播
+   */
+  void ble_reconnect_on_adv_stopped(void);
+
+  /**
+   * @brief 切换到指定绑定槽位(热键触发)
+   *
+   * 断开当前连接并朝目标主机定向广播;
+   * 槽位为空或已是当前主机时不做任何事
+   *
+   * @param slot 槽位号(0..BLE_RECONNECT_MAX_HOSTS-1)
+   * @return true 已发起切换
+   */
+  bool ble_reconnect_switch_to_slot(int slot);
+
+  /**
+   * @brief 获取当前活动槽位(调试用, -1表示无)
+   */
+  int ble_reconnect_get_active_slot(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLE_RECONNECT_H__ */
@@ -0,0 +1,245 @@
+/*
+ * BLE Connection Parameter Negotiation Engine - Implementation File
+ *
+ * 背景: 部分Android/Windows主机无视7.5ms请求,把连接卡在30ms间隔,
+ * 鼠标有效回报率直接打到四分之一。本模块主动协商并校验授予值,
+ * 不满足时沿阶梯重试,空闲时再协商到省电参数。
+ */
+
+#include "conn_params.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mouse_accumulator.h"
+#include <string.h>
+
+static const char *TAG = "CONN_PARAMS";
+
+/* =================================================================================================
+   参数阶梯定义
+   ================================================================================================= */
+
+// 性能模式fallback阶梯(单位1.25ms): 从最优开始逐级放宽,
+// 主机拒绝或授予值超出上限时走下一级
+typedef struct
+{
+  uint16_t min_int;
+  uint16_t max_int;
+  uint16_t latency;
+} conn_params_req_t;
+
+static const conn_params_req_t s_perf_ladder[] = {
+    {6, 6, 0},   // 7.5ms固定,latency 0 (最优)
+    {6, 9, 0},   // 7.5~11.25ms
+    {6, 12, 0},  // 7.5~15ms
+    {6, 24, 0},  // 7.5~30ms (到这一级基本任何主机都会接受)
+};
+#define PERF_LADDER_STEPS (sizeof(s_perf_ladder) / sizeof(s_perf_ladder[0]))
+
+// 宽松模式参数: 30~50ms + slave latency 4,
+// 空闲时radio唤醒频率降到~1/25,对重连延迟无感知影响
+static const conn_params_req_t s_relaxed_req = {24, 40, 4};
+
+// supervision timeout(单位10ms): 5秒,宽松模式下latency 4也留足余量
+#define CONN_PARAMS_TIMEOUT_10MS 500
+
+/* =================================================================================================
+   内部状态
+   ================================================================================================= */
+
+static conn_params_mode_t s_mode = CONN_PARAMS_MODE_IDLE;
+static esp_bd_addr_t s_peer_bda;
+static bool s_connected = false;
+
+// 当前阶梯位置与在途请求标记
+static uint32_t s_ladder_idx = 0;
+static bool s_request_pending = false;
+static conn_params_req_t s_last_req;
+
+// 空闲检测
+static esp_timer_handle_t s_idle_timer = NULL;
+static int64_t s_last_activity_us = 0;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+/**
+ * @brief 发出一次参数更新请求
+ */
+static void send_request(const conn_params_req_t *req)
+{
+  esp_ble_conn_update_params_t params = {0};
+  memcpy(params.bda, s_peer_bda, sizeof(esp_bd_addr_t));
+  params.min_int = req->min_int;
+  params.max_int = req->max_int;
+  params.latency = req->latency;
+  params.timeout = CONN_PARAMS_TIMEOUT_10MS;
+
+  s_last_req = *req;
+  s_request_pending = true;
+
+  esp_err_t ret = esp_ble_gap_update_conn_params(&params);
+  if (ret != ESP_OK)
+  {
+    s_request_pending = false;
+    ESP_LOGW(TAG, "参数更新请求发送失败: %s", esp_err_to_name(ret));
+    return;
+  }
+  ESP_LOGI(TAG, "请求连接参数: interval=%.2f~%.2fms, latency=%u",
+           (float)req->min_int * 1.25f, (float)req->max_int * 1.25f,
+           (unsigned int)req->latency);
+}
+
+/**
+ * @brief 请求性能参数(从阶梯指定级开始)
+ */
+static void request_performance(uint32_t ladder_idx)
+{
+  s_mode = CONN_PARAMS_MODE_PERFORMANCE;
+  s_ladder_idx = (ladder_idx < PERF_LADDER_STEPS) ? ladder_idx : (PERF_LADDER_STEPS - 1);
+  send_request(&s_perf_ladder[s_ladder_idx]);
+}
+
+/**
+ * @brief 空闲检测定时器回调(esp_timer任务,1秒周期)
+ *
+ * 累加器的发送定时器还active说明有输入在流动,刷新活动时间戳;
+ * 超过阈值无活动且仍在性能模式时,协商到宽松参数
+ */
+static void idle_check_callback(void *arg)
+{
+  if (!s_connected || s_request_pending)
+  {
+    return;
+  }
+
+  int64_t now = esp_timer_get_time();
+  if (mouse_accumulator_is_active())
+  {
+    s_last_activity_us = now;
+    return;
+  }
+
+  if (s_mode == CONN_PARAMS_MODE_PERFORMANCE &&
+      (now - s_last_activity_us) >= (int64_t)CONN_PARAMS_IDLE_RELAX_MS * 1000)
+  {
+    ESP_LOGI(TAG, "输入空闲%d秒,协商到宽松参数省电", CONN_PARAMS_IDLE_RELAX_MS / 1000);
+    s_mode = CONN_PARAMS_MODE_RELAXED;
+    send_request(&s_relaxed_req);
+  }
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+esp_err_t conn_params_init(void)
+{
+  const esp_timer_create_args_t timer_args = {
+      .callback = &idle_check_callback,
+      .arg = NULL,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "conn_idle_check"};
+
+  esp_err_t ret = esp_timer_create(&timer_args, &s_idle_timer);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGE(TAG, "创建空闲检测定时器失败: %s", esp_err_to_name(ret));
+    return ret;
+  }
+  ESP_LOGI(TAG, "连接参数协商引擎初始化完成(空闲阈值: %dms)", CONN_PARAMS_IDLE_RELAX_MS);
+  return ESP_OK;
+}
+
+void conn_params_on_connect(esp_bd_addr_t bda)
+{
+  memcpy(s_peer_bda, bda, sizeof(esp_bd_addr_t));
+  s_connected = true;
+  s_last_activity_us = esp_timer_get_time();
+
+  // 从阶梯最优一级开始协商
+  request_performance(0);
+
+  if (s_idle_timer != NULL)
+  {
+    esp_timer_start_periodic(s_idle_timer, (uint64_t)CONN_PARAMS_IDLE_CHECK_MS * 1000);
+  }
+}
+
+void conn_params_on_disconnect(void)
+{
+  s_connected = false;
+  s_mode = CONN_PARAMS_MODE_IDLE;
+  s_request_pending = false;
+  s_ladder_idx = 0;
+  if (s_idle_timer != NULL)
+  {
+    esp_timer_stop(s_idle_timer);
+  }
+}
+
+void conn_params_on_update(bool success, uint16_t conn_int, uint16_t latency, uint16_t timeout)
+{
+  if (!s_connected)
+  {
+    return;
+  }
+
+  // 主机也可能主动发起更新,没有在途请求时只记录,不触发阶梯
+  if (!s_request_pending)
+  {
+    ESP_LOGI(TAG, "主机侧参数更新: interval=%.2fms, latency=%u", (float)conn_int * 1.25f, (unsigned int)latency);
+    return;
+  }
+  s_request_pending = false;
+
+  // 授予值满足请求上限(且latency不超)即认为协商成功
+  bool granted_ok = success &&
+                    conn_int <= s_last_req.max_int &&
+                    latency <= s_last_req.latency;
+
+  if (granted_ok)
+  {
+    ESP_LOGI(TAG, "协商成功[%s]: interval=%.2fms, latency=%u, timeout=%ums",
+             (s_mode == CONN_PARAMS_MODE_RELAXED) ? "宽松" : "性能",
+             (float)conn_int * 1.25f, (unsigned int)latency, (unsigned int)timeout * 10);
+    return;
+  }
+
+  if (s_mode == CONN_PARAMS_MODE_RELAXED)
+  {
+    // 宽松参数被拒绝没有实际损失,保持现状即可
+    ESP_LOGW(TAG, "宽松参数被拒绝(granted interval=%.2fms),保持当前参数", (float)conn_int * 1.25f);
+    return;
+  }
+
+  // 性能模式: 沿阶梯放宽重试,走完阶梯则接受现状
+  if (s_ladder_idx + 1 < PERF_LADDER_STEPS)
+  {
+    ESP_LOGW(TAG, "授予值不满足(granted interval=%.2fms > 请求上限%.2fms),阶梯降级重试",
+             (float)conn_int * 1.25f, (float)s_last_req.max_int * 1.25f);
+    request_performance(s_ladder_idx + 1);
+  }
+  else
+  {
+    ESP_LOGW(TAG, "阶梯已走完,接受主机参数: interval=%.2fms, latency=%u",
+             (float)conn_int * 1.25f, (unsigned int)latency);
+  }
+}
+
+void conn_params_notify_activity(void)
+{
+  s_last_activity_us = esp_timer_get_time();
+
+  // 宽松模式下第一条输入立即切回性能参数
+  if (s_connected && s_mode == CONN_PARAMS_MODE_RELAXED && !s_request_pending)
+  {
+    ESP_LOGI(TAG, "检测到输入活动,切回性能参数");
+    request_performance(0);
+  }
+}
+
+conn_params_mode_t conn_params_get_mode(void)
+{
+  return s_mode;
+}
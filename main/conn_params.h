@@ -0,0 +1,89 @@
+/*
+ * BLE Connection Parameter Negotiation Engine - Header File
+ *
+ * 核心思想:
+ * - 连接后主动请求7.5ms/latency 0,不再被动接受主机给的参数
+ * - 校验实际授予值,被拒绝或授予值过差时沿fallback阶梯逐级放宽重试
+ * - 输入空闲一段时间后协商到宽松间隔+slave latency省电,
+ *   第一条新输入事件立即请求切回7.5ms
+ */
+
+#ifndef CONN_PARAMS_H__
+#define CONN_PARAMS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_gap_ble_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 输入空闲多久后切换到宽松参数(毫秒)
+#define CONN_PARAMS_IDLE_RELAX_MS 10000
+
+// 空闲检测定时器周期(毫秒)
+#define CONN_PARAMS_IDLE_CHECK_MS 1000
+
+  /**
+   * @brief 协商引擎当前模式
+   */
+  typedef enum
+  {
+    CONN_PARAMS_MODE_IDLE = 0,    // 未连接
+    CONN_PARAMS_MODE_PERFORMANCE, // 性能模式(请求7.5ms,latency 0)
+    CONN_PARAMS_MODE_RELAXED,     // 宽松模式(长间隔+slave latency,省电)
+  } conn_params_mode_t;
+
+  /**
+   * @brief 初始化协商引擎(创建空闲检测定时器)
+   *
+   * @return ESP_OK 成功,其他值表示失败
+   */
+  esp_err_t conn_params_init(void);
+
+  /**
+   * @brief BLE连接建立时调用: 发起性能参数请求并启动空闲检测
+   *
+   * @param bda 对端地址
+   */
+  void conn_params_on_connect(esp_bd_addr_t bda);
+
+  /**
+   * @brief BLE断开时调用: 停止空闲检测并复位协商状态
+   */
+  void conn_params_on_disconnect(void);
+
+  /**
+   * @brief ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT时调用: 校验授予值
+   *
+   * 被拒绝或授予间隔超出请求上限时沿fallback阶梯重试;
+   * 阶梯走完仍不满足则接受现状并记录日志
+   *
+   * @param success 更新状态是否为ESP_BT_STATUS_SUCCESS
+   * @param conn_int 授予的连接间隔(单位1.25ms)
+   * @param latency 授予的slave latency
+   * @param timeout 授予的supervision timeout(单位10ms)
+   */
+  void conn_params_on_update(bool success, uint16_t conn_int, uint16_t latency, uint16_t timeout);
+
+  /**
+   * @brief 输入活动通知(空闲->活动迁移时调用)
+   *
+   * 宽松模式下立即请求切回性能参数;
+   * 由mouse_accumulator的idle->active迁移触发,不在每事件热路径上
+   */
+  void conn_params_notify_activity(void);
+
+  /**
+   * @brief 获取当前模式(调试用)
+   */
+  conn_params_mode_t conn_params_get_mode(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONN_PARAMS_H__ */
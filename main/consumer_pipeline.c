@@ -0,0 +1,264 @@
+/*
+ * Consumer Control Pipeline - 实现文件
+ *
+ * 核心逻辑:
+ * - USB侧: 按枚举时编译的计划扫描位图/数组字段,得到当前按下的
+ *   16位usage(0=无);状态变化入无锁SPSC队列并立即唤醒发送任务
+ * - BLE侧: ble_tx任务节拍排空队列,按下/释放背靠背notify,
+ *   快速敲击的两条边沿在同一窗口内发出,不再各等一个间隔
+ * - 未配置布局时回退为LE16直通(16位usage数组是USB侧最常见形态)
+ */
+
+#include "consumer_pipeline.h"
+#include "esp_log.h"
+#include "hid_dev.h"
+#include "hid_host_example.h"
+#include "hot_path.h"
+#include "mouse_accumulator.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "CONSUMER_PL";
+
+// 提取布局(枚举任务写一次,之后只读;s_configured做发布屏障)
+static hid_consumer_layout_t s_layout;
+static atomic_bool s_configured = false;
+
+// 状态变化队列(无锁SPSC,与keyboard_queue同样的head/tail设计)
+// 条目为"当前按下的usage",0表示全部释放
+typedef struct
+{
+  uint16_t states[CONSUMER_QUEUE_CAPACITY];
+  _Atomic uint32_t head; // 写入索引(仅生产者递增)
+  _Atomic uint32_t tail; // 读取索引(仅消费者递增)
+} cc_queue_t;
+
+static cc_queue_t g_queue = {
+    .head = 0,
+    .tail = 0};
+
+// 生产者端状态(仅report_worker任务访问)
+// 溢出槽: 队列满时暂存最新状态,腾出空间后优先补发
+static uint16_t s_overflow_state;
+static bool s_overflow_valid = false;
+static uint16_t s_last_usage = 0;
+
+// 统计(各自只有单一写者)
+static uint32_t s_total_pushed = 0;
+static uint32_t s_total_sent = 0;
+static uint32_t s_total_coalesced = 0;
+static uint32_t s_total_failures = 0;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+static uint32_t HOT_PATH_IRAM_ATTR queue_count(void)
+{
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  return head - tail;
+}
+
+// 生产者: 尝试写入一个状态变化,满时返回false
+static bool HOT_PATH_IRAM_ATTR queue_push_raw(uint16_t state)
+{
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_acquire);
+
+  if (head - tail >= CONSUMER_QUEUE_CAPACITY)
+  {
+    return false;
+  }
+
+  g_queue.states[head & CONSUMER_QUEUE_MASK] = state;
+  atomic_store_explicit(&g_queue.head, head + 1, memory_order_release);
+  return true;
+}
+
+// 按布局提取当前按下的usage(0=无);多键同按取第一个
+static uint16_t HOT_PATH_IRAM_ATTR extract_active_usage(const uint8_t *data, int length)
+{
+  for (int i = 0; i < s_layout.bit_count; i++)
+  {
+    const hid_consumer_bit_t *bit = &s_layout.bits[i];
+    if (hid_field_extract_u32(&bit->field, data, length) != 0)
+    {
+      return bit->usage;
+    }
+  }
+  for (int i = 0; i < s_layout.array_count; i++)
+  {
+    const hid_consumer_array_t *arr = &s_layout.arrays[i];
+    int32_t v = (int32_t)hid_field_extract_u32(&arr->field, data, length);
+    int32_t idx = v - arr->logical_min;
+    uint16_t usage = (uint16_t)(arr->usage_min + idx);
+    if (v != 0 && idx >= 0 && usage <= arr->usage_max)
+    {
+      return usage;
+    }
+  }
+  return 0;
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+void consumer_pipeline_init(void)
+{
+  consumer_pipeline_clear();
+  ESP_LOGI(TAG, "消费类管线初始化成功(队列容量: %d)", CONSUMER_QUEUE_CAPACITY);
+}
+
+void consumer_pipeline_clear(void)
+{
+  // 消费者方式排空: tail推进到head(保持SPSC约束,不重置索引)
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  atomic_store_explicit(&g_queue.tail, head, memory_order_release);
+  s_overflow_valid = false;
+  s_last_usage = 0;
+}
+
+bool consumer_pipeline_configure(const hid_consumer_layout_t *layout)
+{
+  if (layout == NULL || (layout->bit_count == 0 && layout->array_count == 0))
+  {
+    return false;
+  }
+  atomic_store(&s_configured, false);
+  s_layout = *layout;
+  consumer_pipeline_clear();
+  atomic_store(&s_configured, true);
+  ESP_LOGI(TAG, "消费类布局已配置: report_id=%d, 位图%d位, 数组%d槽",
+           s_layout.report_id, s_layout.bit_count, s_layout.array_count);
+  return true;
+}
+
+void consumer_pipeline_reset(void)
+{
+  atomic_store(&s_configured, false);
+  consumer_pipeline_clear();
+}
+
+void HOT_PATH_IRAM_ATTR consumer_pipeline_push(const uint8_t *data, int length, bool has_report_id)
+{
+  if (data == NULL || length <= 0)
+  {
+    return;
+  }
+
+  uint16_t usage;
+  if (atomic_load(&s_configured))
+  {
+    if (length < s_layout.min_length)
+    {
+      return;
+    }
+    usage = extract_active_usage(data, length);
+  }
+  else
+  {
+    // 回退: 按最常见的16位usage数组形态直通(跳过report_id)
+    const uint8_t *payload = has_report_id ? &data[1] : &data[0];
+    int payload_length = has_report_id ? (length - 1) : length;
+    if (payload_length <= 0)
+    {
+      return;
+    }
+    usage = payload[0];
+    if (payload_length >= 2)
+    {
+      usage |= (uint16_t)payload[1] << 8;
+    }
+  }
+
+  // 只有状态变化才是信息,重复状态计入合并
+  if (usage == s_last_usage)
+  {
+    s_total_coalesced++;
+    return;
+  }
+
+  // 先补发之前因队列满暂存的溢出状态,保持顺序
+  if (s_overflow_valid && queue_push_raw(s_overflow_state))
+  {
+    s_overflow_valid = false;
+    s_total_pushed++;
+  }
+
+  if (!s_overflow_valid && queue_push_raw(usage))
+  {
+    s_total_pushed++;
+  }
+  else
+  {
+    // 队列仍满: 溢出槽只保留最新状态(中间状态被取代,最终状态不丢)
+    if (s_overflow_valid)
+    {
+      s_total_coalesced++;
+    }
+    s_overflow_state = usage;
+    s_overflow_valid = true;
+  }
+  s_last_usage = usage;
+
+  // 立即唤醒发送任务(媒体键稀疏,不存在唤醒风暴)
+  mouse_accumulator_request_send();
+}
+
+void HOT_PATH_IRAM_ATTR consumer_pipeline_try_send(void)
+{
+  if (!mouse_accumulator_is_ble_connected())
+  {
+    return;
+  }
+
+  // 拥塞流控: 控制器队列满时状态留在队列中,拥塞解除后再发
+  if (hid_dev_is_congested())
+  {
+    return;
+  }
+
+  // 依次发送所有待发状态;同一窗口内的按下/释放背靠背notify,
+  // 失败时停止,剩余状态下个节拍重试
+  while (queue_count() > 0)
+  {
+    uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+    uint16_t usage = g_queue.states[tail & CONSUMER_QUEUE_MASK];
+    uint8_t report[CONSUMER_RPT_LEN] = {(uint8_t)(usage & 0xFF), (uint8_t)(usage >> 8)};
+
+    esp_err_t ret = consumer_pipeline_send_ble_report(report, CONSUMER_RPT_LEN);
+    if (ret != ESP_OK)
+    {
+      s_total_failures++;
+      // 通知未启用是正常状态,不打日志
+      if (ret != ESP_ERR_INVALID_STATE)
+      {
+        ESP_LOGW(TAG, "消费类报告发送失败(%s),保留队列下次重试", esp_err_to_name(ret));
+      }
+      return;
+    }
+
+    atomic_store_explicit(&g_queue.tail, tail + 1, memory_order_release);
+    s_total_sent++;
+  }
+}
+
+void consumer_pipeline_get_stats(uint32_t *pending,
+                                 uint32_t *total_pushed,
+                                 uint32_t *total_sent,
+                                 uint32_t *total_coalesced,
+                                 uint32_t *total_failures)
+{
+  if (pending)
+    *pending = queue_count() + (s_overflow_valid ? 1 : 0);
+  if (total_pushed)
+    *total_pushed = s_total_pushed;
+  if (total_sent)
+    *total_sent = s_total_sent;
+  if (total_coalesced)
+    *total_coalesced = s_total_coalesced;
+  if (total_failures)
+    *total_failures = s_total_failures;
+}
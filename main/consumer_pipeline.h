@@ -0,0 +1,87 @@
+/*
+ * Consumer Control Pipeline - 头文件
+ *
+ * 核心思想:
+ * - 旧路径把USB消费类报告的原始字节直接拷进BLE CC报告,
+ *   只有布局碰巧一致的设备能用;其余媒体键全部丢失
+ * - 新管线在枚举阶段解析设备自己的usage位图/数组布局,
+ *   热路径按计划提取出"当前按下的16位usage",直接写进BLE报告,
+ *   任意Consumer Page usage无需逐个适配
+ * - 按下/释放走无锁SPSC队列(keyboard_queue同构),同一发送窗口
+ *   内到达的多个状态变化由ble_tx任务一次排空、背靠背notify
+ */
+
+#ifndef CONSUMER_PIPELINE_H__
+#define CONSUMER_PIPELINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hid_report_parser_c.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// BLE CC报告长度: 一个16位usage(0=全部释放)
+#define CONSUMER_RPT_LEN 2
+
+// 状态变化队列容量(必须是2的幂)
+#define CONSUMER_QUEUE_CAPACITY 16
+#define CONSUMER_QUEUE_MASK (CONSUMER_QUEUE_CAPACITY - 1)
+
+  /**
+   * @brief 初始化管线
+   */
+  void consumer_pipeline_init(void);
+
+  /**
+   * @brief 清空待发状态(BLE断开时调用)
+   */
+  void consumer_pipeline_clear(void);
+
+  /**
+   * @brief 配置提取布局(枚举阶段,解析出消费类布局后调用)
+   *
+   * @param layout 解析出的布局(提取计划已编译)
+   * @return true 配置成功
+   */
+  bool consumer_pipeline_configure(const hid_consumer_layout_t *layout);
+
+  /**
+   * @brief 取消配置(消费类设备断开时调用)
+   *
+   * push回退到LE16直通(常见USB消费类报告本来就是16位usage数组)
+   */
+  void consumer_pipeline_reset(void);
+
+  /**
+   * @brief 推入一条原始USB消费类报告(report_worker任务调用)
+   *
+   * 按计划提取当前按下的usage,与上一状态不同时入队并唤醒发送任务
+   *
+   * @param data 原始报告数据(含report_id字节时计划偏移已包含)
+   * @param length 报告字节数
+   * @param has_report_id 报告首字节是否为report_id(未配置的回退路径用)
+   */
+  void consumer_pipeline_push(const uint8_t *data, int length, bool has_report_id);
+
+  /**
+   * @brief 发送节拍(ble_tx任务调用),排空队列背靠背notify
+   */
+  void consumer_pipeline_try_send(void);
+
+  /**
+   * @brief 获取统计信息(参数可为NULL)
+   */
+  void consumer_pipeline_get_stats(uint32_t *pending,
+                                   uint32_t *total_pushed,
+                                   uint32_t *total_sent,
+                                   uint32_t *total_coalesced,
+                                   uint32_t *total_failures);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSUMER_PIPELINE_H__ */
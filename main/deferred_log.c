@@ -0,0 +1,172 @@
+/*
+ * Deferred Logging - Implementation File (热路径异步日志)
+ *
+ * 无锁结构: 有界多生产者/单消费者环(每槽位序号法)
+ * - 多个生产者(USB回调core 0 / ble_tx任务core 1)用CAS认领槽位,
+ *   写完payload后以release发布槽位序号
+ * - 单消费者(drain任务)按tail顺序消费,读到的槽位序号不匹配就等下一轮
+ * - 环满直接丢弃并计数,热路径永不自旋等待
+ */
+
+#include "deferred_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+#include <stdio.h>
+
+static const char *TAG = "DLOG";
+
+// 单条记录: 固定大小,字符串只存字面量指针
+typedef struct
+{
+  int64_t t_us;     // 写入时刻(格式化时打印,和实际打印时刻区分开)
+  const char *tag;  // 模块TAG(字面量)
+  const char *fmt;  // 格式串(字面量)
+  int32_t args[DLOG_MAX_ARGS];
+  uint8_t level;    // esp_log_level_t
+} dlog_record_t;
+
+// 每槽位带序号的cell(序号法MPSC环)
+typedef struct
+{
+  _Atomic uint32_t seq;
+  dlog_record_t rec;
+} dlog_cell_t;
+
+static dlog_cell_t s_ring[DLOG_RING_CAPACITY];
+static _Atomic uint32_t s_head = 0; // 生产者CAS认领
+static uint32_t s_tail = 0;         // 仅drain任务访问
+
+// 统计(total多写者,用原子;dropped同理)
+static _Atomic uint32_t s_total = 0;
+static _Atomic uint32_t s_dropped = 0;
+
+static TaskHandle_t s_drain_task = NULL;
+
+void deferred_log_write(esp_log_level_t level, const char *tag, const char *fmt,
+                        int32_t a0, int32_t a1, int32_t a2, int32_t a3)
+{
+  // 认领一个槽位: cell序号等于pos说明槽位空闲
+  uint32_t pos = atomic_load_explicit(&s_head, memory_order_relaxed);
+  dlog_cell_t *cell;
+  while (true)
+  {
+    cell = &s_ring[pos & DLOG_RING_MASK];
+    uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    int32_t dif = (int32_t)(seq - pos);
+
+    if (dif == 0)
+    {
+      // 槽位空闲,尝试认领
+      if (atomic_compare_exchange_weak_explicit(&s_head, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+      {
+        break;
+      }
+      // CAS失败: pos已被更新为最新head,重试
+    }
+    else if (dif < 0)
+    {
+      // 环满: 丢弃本条,热路径绝不等待
+      atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+      return;
+    }
+    else
+    {
+      // 其他生产者已认领,跟进最新head
+      pos = atomic_load_explicit(&s_head, memory_order_relaxed);
+    }
+  }
+
+  // 写payload,然后以release发布(消费者以acquire读seq后payload已可见)
+  cell->rec.t_us = esp_timer_get_time();
+  cell->rec.tag = tag;
+  cell->rec.fmt = fmt;
+  cell->rec.args[0] = a0;
+  cell->rec.args[1] = a1;
+  cell->rec.args[2] = a2;
+  cell->rec.args[3] = a3;
+  cell->rec.level = (uint8_t)level;
+  atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+  atomic_fetch_add_explicit(&s_total, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief drain任务: 低优先级轮询,格式化并打印积压的记录
+ */
+static void dlog_drain_task(void *arg)
+{
+  uint32_t last_dropped = 0;
+
+  while (true)
+  {
+    // 消费所有已发布的记录
+    while (true)
+    {
+      dlog_cell_t *cell = &s_ring[s_tail & DLOG_RING_MASK];
+      uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+      if ((int32_t)(seq - (s_tail + 1)) != 0)
+      {
+        break; // 下一条还没发布
+      }
+
+      dlog_record_t rec = cell->rec;
+      // 释放槽位给下一圈的生产者
+      atomic_store_explicit(&cell->seq, s_tail + DLOG_RING_CAPACITY, memory_order_release);
+      s_tail++;
+
+      // 格式化到本地缓冲(snprintf忽略超出格式串的多余参数,标准行为),
+      // 前缀带写入时刻,和实际打印时刻区分开,便于与事件对齐
+      char buf[160];
+      snprintf(buf, sizeof(buf), rec.fmt,
+               rec.args[0], rec.args[1], rec.args[2], rec.args[3]);
+      ESP_LOG_LEVEL((esp_log_level_t)rec.level, rec.tag,
+                    "[t=%lld.%06llds] %s",
+                    (long long)(rec.t_us / 1000000), (long long)(rec.t_us % 1000000), buf);
+    }
+
+    // 报告丢弃(只在数字变化时打一次)
+    uint32_t dropped = atomic_load_explicit(&s_dropped, memory_order_relaxed);
+    if (dropped != last_dropped)
+    {
+      ESP_LOGW(TAG, "环满丢弃了%lu条诊断记录", (unsigned long)(dropped - last_dropped));
+      last_dropped = dropped;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_INTERVAL_MS));
+  }
+}
+
+esp_err_t deferred_log_init(void)
+{
+  // 初始化槽位序号
+  for (uint32_t i = 0; i < DLOG_RING_CAPACITY; i++)
+  {
+    atomic_store_explicit(&s_ring[i].seq, i, memory_order_relaxed);
+  }
+
+  BaseType_t created = xTaskCreate(dlog_drain_task,
+                                   "dlog_drain",
+                                   DLOG_TASK_STACK_SIZE,
+                                   NULL,
+                                   DLOG_TASK_PRIORITY,
+                                   &s_drain_task);
+  if (created != pdTRUE)
+  {
+    ESP_LOGE(TAG, "创建日志drain任务失败");
+    return ESP_ERR_NO_MEM;
+  }
+
+  ESP_LOGI(TAG, "延迟日志初始化完成(环容量%d条, drain周期%dms)",
+           DLOG_RING_CAPACITY, DLOG_DRAIN_INTERVAL_MS);
+  return ESP_OK;
+}
+
+void deferred_log_get_stats(uint32_t *total, uint32_t *dropped)
+{
+  if (total)
+    *total = atomic_load_explicit(&s_total, memory_order_relaxed);
+  if (dropped)
+    *dropped = atomic_load_explicit(&s_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,81 @@
+/*
+ * Deferred Logging - Header File (热路径异步日志)
+ *
+ * 核心思想:
+ * - 热路径(USB报告回调/BLE发送路径)只把固定大小的二进制记录写进无锁环,
+ *   不触碰UART,单条开销在百ns量级
+ * - 低优先级drain任务负责格式化和打印,诊断开着也不吃1ms回调预算
+ * - 格式串和TAG必须是字符串字面量(只存指针不拷贝内容)
+ * - 参数统一为最多4个int32(指针/浮点不支持,热路径诊断用不上)
+ */
+
+#ifndef DEFERRED_LOG_H__
+#define DEFERRED_LOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 环容量(必须是2的幂): 64条足够覆盖drain任务一个调度周期内的突发
+#define DLOG_RING_CAPACITY 64
+#define DLOG_RING_MASK (DLOG_RING_CAPACITY - 1)
+
+// 单条记录的参数个数上限
+#define DLOG_MAX_ARGS 4
+
+// drain任务配置: 低优先级,不固定核,打印永远让位于输入路径
+#define DLOG_TASK_STACK_SIZE 3072
+#define DLOG_TASK_PRIORITY 1
+#define DLOG_DRAIN_INTERVAL_MS 100
+
+  /**
+   * @brief 初始化延迟日志模块(创建drain任务)
+   *
+   * @return ESP_OK 成功,其他值表示失败
+   */
+  esp_err_t deferred_log_init(void);
+
+  /**
+   * @brief 写入一条延迟日志记录(热路径,无锁,多生产者安全)
+   *
+   * 环满时丢弃本条并计数(诊断丢失好过阻塞输入路径);
+   * 不要直接调用,用下面的DLOGW/DLOGI宏
+   *
+   * @param level ESP_LOG_WARN或ESP_LOG_INFO
+   * @param tag 模块TAG(必须是字面量)
+   * @param fmt 格式串(必须是字面量,最多消费4个int32参数)
+   */
+  void deferred_log_write(esp_log_level_t level, const char *tag, const char *fmt,
+                          int32_t a0, int32_t a1, int32_t a2, int32_t a3);
+
+  /**
+   * @brief 获取统计信息(调试用)
+   *
+   * @param total 总写入条数
+   * @param dropped 环满丢弃条数
+   */
+  void deferred_log_get_stats(uint32_t *total, uint32_t *dropped);
+
+// 热路径日志宏: 参数不足4个时补0(printf忽略多余参数是标准行为)
+#define DLOGW0(tag, fmt) deferred_log_write(ESP_LOG_WARN, tag, fmt, 0, 0, 0, 0)
+#define DLOGW1(tag, fmt, a) deferred_log_write(ESP_LOG_WARN, tag, fmt, (int32_t)(a), 0, 0, 0)
+#define DLOGW2(tag, fmt, a, b) deferred_log_write(ESP_LOG_WARN, tag, fmt, (int32_t)(a), (int32_t)(b), 0, 0)
+#define DLOGW3(tag, fmt, a, b, c) deferred_log_write(ESP_LOG_WARN, tag, fmt, (int32_t)(a), (int32_t)(b), (int32_t)(c), 0)
+#define DLOGW4(tag, fmt, a, b, c, d) deferred_log_write(ESP_LOG_WARN, tag, fmt, (int32_t)(a), (int32_t)(b), (int32_t)(c), (int32_t)(d))
+#define DLOGI0(tag, fmt) deferred_log_write(ESP_LOG_INFO, tag, fmt, 0, 0, 0, 0)
+#define DLOGI1(tag, fmt, a) deferred_log_write(ESP_LOG_INFO, tag, fmt, (int32_t)(a), 0, 0, 0)
+#define DLOGI2(tag, fmt, a, b) deferred_log_write(ESP_LOG_INFO, tag, fmt, (int32_t)(a), (int32_t)(b), 0, 0)
+#define DLOGI3(tag, fmt, a, b, c) deferred_log_write(ESP_LOG_INFO, tag, fmt, (int32_t)(a), (int32_t)(b), (int32_t)(c), 0)
+#define DLOGI4(tag, fmt, a, b, c, d) deferred_log_write(ESP_LOG_INFO, tag, fmt, (int32_t)(a), (int32_t)(b), (int32_t)(c), (int32_t)(d))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEFERRED_LOG_H__ */
@@ -27,9 +27,9 @@
 #define USE_16BIT_MOUSE_PRECISION 1
 #endif
 
-// 基于 report map: 按钮(1字节: 5位按钮+3位padding) + X(2字节, 16bit) + Y(2字节, 16bit) + Wheel(1字节) = 6字节
-// 注意：即使发送 8bit 数据，报告长度仍为 6 字节（8bit 数据放在 16bit 字段的低 8 位）
-#define HID_MOUSE_IN_RPT_LEN 6 // 按钮(1) + X(2) + Y(2) + Wheel(1) = 6字节（兼容 8bit 和 16bit）
+// 基于 report map: 按钮(1字节: 5位按钮+3位padding) + X(2字节, 16bit) + Y(2字节, 16bit) + Wheel(1字节) + AC Pan(1字节) = 7字节
+// 注意：即使发送 8bit 数据，报告长度仍为 7 字节（8bit 数据放在 16bit 字段的低 8 位）
+#define HID_MOUSE_IN_RPT_LEN 7 // 按钮(1) + X(2) + Y(2) + Wheel(1) + AC Pan(1) = 7字节（兼容 8bit 和 16bit）
 
 // HID consumer control input report length
 #define HID_CC_IN_RPT_LEN 2
@@ -107,11 +107,12 @@ uint16_t esp_hidd_get_version(void)
 
 void esp_hidd_send_consumer_value(uint16_t conn_id, uint8_t key_cmd, bool key_pressed)
 {
+  // CC报告现在是16位usage数组: HID_CONSUMER_*值本身就是usage ID,
+  // 直接写入即可,释放上报0
   uint8_t buffer[HID_CC_IN_RPT_LEN] = {0, 0};
   if (key_pressed)
   {
-    ESP_LOGD(HID_LE_PRF_TAG, "hid_consumer_build_report");
-    hid_consumer_build_report(buffer, key_cmd);
+    buffer[0] = key_cmd;
   }
   ESP_LOGD(HID_LE_PRF_TAG, "buffer[0] = %x, buffer[1] = %x", buffer[0], buffer[1]);
   hid_dev_send_report(hidd_le_env.gatt_if, conn_id,
@@ -181,8 +182,9 @@ void esp_hidd_send_mouse_value(uint16_t conn_id, uint8_t mouse_button, int8_t mi
   buffer[4] = (uint8_t)((y_16 >> 8) & 0xFF);
 #endif
 
-  // Wheel字段（字节5），默认为0（此函数不支持滚轮参数，需要单独的函数）
+  // Wheel/AC Pan字段（字节5-6），默认为0（此函数不支持滚轮参数，需要单独的函数）
   buffer[5] = 0;
+  buffer[6] = 0;
 
   hid_dev_send_report(hidd_le_env.gatt_if, conn_id,
                       HID_RPT_ID_MOUSE_IN, HID_REPORT_TYPE_INPUT, HID_MOUSE_IN_RPT_LEN, buffer);
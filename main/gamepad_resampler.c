@@ -0,0 +1,316 @@
+/*
+ * Gamepad Report Resampler - 实现文件
+ *
+ * 核心逻辑:
+ * - USB侧: 按预编译计划提取字段;轴打包进64位原子最新值槽,
+ *   按钮状态变化入无锁SPSC过渡队列(与keyboard_queue同构)
+ * - BLE侧: ble_tx任务节拍驱动,一个窗口最多notify一个报告;
+ *   过渡优先(保证按下/释放不丢),轴更新按默认窗口限速
+ */
+
+#include "gamepad_resampler.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "hid_dev.h"
+#include "hid_host_example.h"
+#include "hot_path.h"
+#include "mouse_accumulator.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "GAMEPAD_RS";
+
+// 提取计划(枚举任务写一次,之后只读;s_configured做发布屏障)
+static hid_gamepad_plan_t s_plan;
+static atomic_bool s_configured = false;
+
+// 轴最新值槽: 6轴+帽开关打包为7字节,64位原子读写跨任务安全
+static _Atomic uint64_t s_latest_axes = 0;
+
+// 按钮过渡队列(无锁SPSC,与keyboard_queue同样的head/tail设计)
+typedef struct
+{
+  uint32_t buttons[GAMEPAD_QUEUE_CAPACITY];
+  _Atomic uint32_t head; // 写入索引(仅生产者递增)
+  _Atomic uint32_t tail; // 读取索引(仅消费者递增)
+} gp_queue_t;
+
+static gp_queue_t g_queue = {
+    .head = 0,
+    .tail = 0};
+
+// 生产者端状态(仅report_worker任务访问)
+// 溢出槽: 队列满时暂存最新按钮状态,腾出空间后优先补发
+static uint32_t s_overflow_buttons;
+static bool s_overflow_valid = false;
+static uint32_t s_last_pushed_buttons = 0;
+static bool s_last_pushed_valid = false;
+
+// 消费者端状态(仅ble_tx任务访问)
+static uint8_t s_sent_report[GAMEPAD_RPT_LEN];
+static bool s_sent_valid = false;
+static uint64_t s_last_send_us = 0;
+
+// 统计(各自只有单一写者)
+static uint32_t s_total_pushed = 0;
+static uint32_t s_total_sent = 0;
+static uint32_t s_total_coalesced = 0;
+static uint32_t s_total_failures = 0;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+static uint32_t HOT_PATH_IRAM_ATTR queue_count(void)
+{
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  return head - tail;
+}
+
+// 生产者: 尝试写入一个按钮过渡,满时返回false
+static bool HOT_PATH_IRAM_ATTR queue_push_raw(uint32_t buttons)
+{
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_acquire);
+
+  if (head - tail >= GAMEPAD_QUEUE_CAPACITY)
+  {
+    return false;
+  }
+
+  g_queue.buttons[head & GAMEPAD_QUEUE_MASK] = buttons;
+  atomic_store_explicit(&g_queue.head, head + 1, memory_order_release);
+  return true;
+}
+
+// 按计划提取一个轴并归一到int8量程
+static int8_t HOT_PATH_IRAM_ATTR extract_axis(int slot, const uint8_t *data, int length)
+{
+  const hid_field_plan_t *f = &s_plan.axes[slot];
+  if (f->kind == HID_FIELD_NONE)
+  {
+    return 0;
+  }
+  int32_t v = hid_field_extract_s32(f, data, length);
+  v = (v - s_plan.axis_center[slot]) >> s_plan.axis_downshift[slot];
+  if (v < -127)
+    v = -127;
+  if (v > 127)
+    v = 127;
+  return (int8_t)v;
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+void gamepad_resampler_init(void)
+{
+  gamepad_resampler_clear();
+  ESP_LOGI(TAG, "手柄重采样器初始化成功(过渡队列容量: %d)", GAMEPAD_QUEUE_CAPACITY);
+}
+
+void gamepad_resampler_clear(void)
+{
+  // 消费者方式排空: tail推进到head(保持SPSC约束,不重置索引)
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  atomic_store_explicit(&g_queue.tail, head, memory_order_release);
+  atomic_store(&s_latest_axes, 0);
+  s_overflow_valid = false;
+  s_last_pushed_valid = false;
+  s_sent_valid = false;
+  memset(s_sent_report, 0, sizeof(s_sent_report));
+}
+
+bool gamepad_resampler_configure(const hid_gamepad_layout_t *layout)
+{
+  if (layout == NULL)
+  {
+    return false;
+  }
+  atomic_store(&s_configured, false);
+  hid_gamepad_plan_compile(layout, &s_plan);
+  gamepad_resampler_clear();
+  atomic_store(&s_configured, true);
+  ESP_LOGI(TAG, "手柄布局已配置: report_id=%d, 最小长度=%d字节, 按钮=%d个",
+           s_plan.report_id, s_plan.min_length,
+           (int)(s_plan.buttons.kind != HID_FIELD_NONE ? s_plan.buttons.bit_size : 0));
+  return true;
+}
+
+void gamepad_resampler_reset(void)
+{
+  atomic_store(&s_configured, false);
+  gamepad_resampler_clear();
+}
+
+void HOT_PATH_IRAM_ATTR gamepad_resampler_push(const uint8_t *data, int length)
+{
+  if (!atomic_load(&s_configured) || data == NULL || length < s_plan.min_length)
+  {
+    return;
+  }
+
+  // 轴/帽开关: 打包进最新值槽,后到的采样直接取代前值
+  uint8_t axes[8] = {0};
+  for (int i = 0; i < HID_GAMEPAD_AXES; i++)
+  {
+    axes[i] = (uint8_t)extract_axis(i, data, length);
+  }
+  if (s_plan.hat.kind != HID_FIELD_NONE)
+  {
+    // 转成BLE报告约定的1..8,静止位置(越界值)为0
+    uint32_t raw = hid_field_extract_u32(&s_plan.hat, data, length);
+    int32_t rel = (int32_t)raw - s_plan.hat_min;
+    axes[6] = (rel >= 0 && rel < 8) ? (uint8_t)(rel + 1) : 0;
+  }
+  uint64_t packed;
+  memcpy(&packed, axes, sizeof(packed));
+  atomic_store(&s_latest_axes, packed);
+
+  // 按钮: 只有状态变化才是信息,重复状态计入合并
+  uint32_t buttons = hid_field_extract_u32(&s_plan.buttons, data, length);
+  bool queued = false;
+  if (!s_last_pushed_valid || buttons != s_last_pushed_buttons)
+  {
+    // 先补发之前因队列满暂存的溢出过渡,保持顺序
+    if (s_overflow_valid && queue_push_raw(s_overflow_buttons))
+    {
+      s_overflow_valid = false;
+      s_total_pushed++;
+    }
+
+    if (!s_overflow_valid && queue_push_raw(buttons))
+    {
+      s_total_pushed++;
+    }
+    else
+    {
+      // 队列仍满: 溢出槽只保留最新状态(中间状态被取代,最终状态不丢)
+      if (s_overflow_valid)
+      {
+        s_total_coalesced++;
+      }
+      s_overflow_buttons = buttons;
+      s_overflow_valid = true;
+    }
+    s_last_pushed_buttons = buttons;
+    s_last_pushed_valid = true;
+    queued = true;
+  }
+  else
+  {
+    s_total_coalesced++;
+  }
+
+  // 过渡立即唤醒发送任务;纯轴更新靠周期节拍重采样,
+  // 但空闲(定时器停着)时也要唤醒,否则首个轴采样发不出去
+  if (queued || !mouse_accumulator_is_active())
+  {
+    mouse_accumulator_request_send();
+  }
+}
+
+void HOT_PATH_IRAM_ATTR gamepad_resampler_try_send(void)
+{
+  if (!atomic_load(&s_configured) || !mouse_accumulator_is_ble_connected())
+  {
+    return;
+  }
+
+  // 拥塞流控: 控制器队列满时状态留在队列/最新值槽中,拥塞解除后再发
+  if (hid_dev_is_congested())
+  {
+    return;
+  }
+
+  uint8_t report[GAMEPAD_RPT_LEN];
+  uint64_t packed = atomic_load(&s_latest_axes);
+  memcpy(report, &packed, 7);
+
+  bool has_transition = (queue_count() > 0);
+  if (has_transition)
+  {
+    uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+    uint32_t buttons = g_queue.buttons[tail & GAMEPAD_QUEUE_MASK];
+    report[7] = (uint8_t)(buttons & 0xFF);
+    report[8] = (uint8_t)((buttons >> 8) & 0xFF);
+    report[9] = (uint8_t)((buttons >> 16) & 0xFF);
+    report[10] = (uint8_t)((buttons >> 24) & 0xFF);
+
+    esp_err_t ret = gamepad_resampler_send_ble_report(report, GAMEPAD_RPT_LEN);
+    if (ret != ESP_OK)
+    {
+      s_total_failures++;
+      // 通知未启用是正常状态,不打日志
+      if (ret != ESP_ERR_INVALID_STATE)
+      {
+        ESP_LOGW(TAG, "手柄报告发送失败(%s),保留队列下次重试", esp_err_to_name(ret));
+      }
+      return;
+    }
+    atomic_store_explicit(&g_queue.tail, tail + 1, memory_order_release);
+    // 一个窗口最多一个报告: 剩余过渡留给后续节拍
+  }
+  else
+  {
+    // 纯轴更新: 与上次发送相同就没有信息量;有变化也按默认窗口限速,
+    // 1000Hz轴流不会放大成1000Hz的notify
+    memcpy(&report[7], &s_sent_report[7], 4);
+    if (s_sent_valid && memcmp(report, s_sent_report, GAMEPAD_RPT_LEN) == 0)
+    {
+      return;
+    }
+    uint64_t now = esp_timer_get_time();
+    if (s_sent_valid && (now - s_last_send_us) < BLE_SEND_INTERVAL_US_DEFAULT)
+    {
+      return;
+    }
+
+    esp_err_t ret = gamepad_resampler_send_ble_report(report, GAMEPAD_RPT_LEN);
+    if (ret != ESP_OK)
+    {
+      s_total_failures++;
+      if (ret != ESP_ERR_INVALID_STATE)
+      {
+        ESP_LOGW(TAG, "手柄轴报告发送失败(%s),下个节拍重试", esp_err_to_name(ret));
+      }
+      return;
+    }
+  }
+
+  memcpy(s_sent_report, report, GAMEPAD_RPT_LEN);
+  s_sent_valid = true;
+  s_last_send_us = esp_timer_get_time();
+  s_total_sent++;
+}
+
+void gamepad_resampler_get_stats(uint32_t *pending,
+                                 uint32_t *total_pushed,
+                                 uint32_t *total_sent,
+                                 uint32_t *total_coalesced,
+                                 uint32_t *total_failures)
+{
+  if (pending)
+  {
+    uint32_t p = queue_count() + (s_overflow_valid ? 1 : 0);
+    // 未发出的轴更新也算待发(空闲门控用,避免轴流还在动时停掉节拍)
+    uint64_t packed = atomic_load(&s_latest_axes);
+    uint8_t axes[8];
+    memcpy(axes, &packed, sizeof(axes));
+    if (memcmp(axes, s_sent_report, 7) != 0)
+    {
+      p++;
+    }
+    *pending = p;
+  }
+  if (total_pushed)
+    *total_pushed = s_total_pushed;
+  if (total_sent)
+    *total_sent = s_total_sent;
+  if (total_coalesced)
+    *total_coalesced = s_total_coalesced;
+  if (total_failures)
+    *total_failures = s_total_failures;
+}
@@ -0,0 +1,89 @@
+/*
+ * Gamepad Report Resampler - 头文件
+ *
+ * 核心思想:
+ * - 1000Hz手柄直接逐包转发会灌满BLE链路,挤占鼠标/键盘特征的空口时间
+ * - 按鼠标累加器同样的时间窗思路重采样,但语义按字段类型区分:
+ *   轴是绝对值,取最新采样(不像鼠标位移那样积分);
+ *   按钮是状态,过渡必须逐个保留(压缩只吃掉重复状态)
+ * - 与鼠标/键盘共享ble_tx任务的发送节拍,一个发送窗口内
+ *   本特征最多发出一个报告
+ * - USB侧(report_worker任务)push,BLE侧(ble_tx任务)try_send,
+ *   轴走原子最新值槽,按钮过渡走无锁SPSC队列
+ */
+
+#ifndef GAMEPAD_RESAMPLER_H__
+#define GAMEPAD_RESAMPLER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hid_report_parser_c.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// BLE gamepad报告长度: 6轴 + 帽开关 + 32位按钮 = 11字节
+#define GAMEPAD_RPT_LEN 11
+
+// 按钮过渡队列容量(必须是2的幂)
+#define GAMEPAD_QUEUE_CAPACITY 16
+#define GAMEPAD_QUEUE_MASK (GAMEPAD_QUEUE_CAPACITY - 1)
+
+  /**
+   * @brief 初始化重采样器
+   */
+  void gamepad_resampler_init(void);
+
+  /**
+   * @brief 清空待发状态(BLE断开时调用)
+   */
+  void gamepad_resampler_clear(void);
+
+  /**
+   * @brief 配置提取计划(枚举阶段,解析出手柄布局后调用)
+   *
+   * @param layout 解析出的手柄布局
+   * @return true 配置成功
+   */
+  bool gamepad_resampler_configure(const hid_gamepad_layout_t *layout);
+
+  /**
+   * @brief 取消配置(手柄设备断开时调用),push变为no-op
+   */
+  void gamepad_resampler_reset(void);
+
+  /**
+   * @brief 推入一条原始USB手柄报告(report_worker任务调用)
+   *
+   * 按计划提取轴/帽/按钮: 轴写入最新值槽(后值取代前值),
+   * 按钮状态变化时入过渡队列并立即唤醒发送任务
+   *
+   * @param data 原始报告数据(含report_id字节,计划偏移已包含)
+   * @param length 报告字节数
+   */
+  void gamepad_resampler_push(const uint8_t *data, int length);
+
+  /**
+   * @brief 发送节拍(ble_tx任务调用),每次最多发出一个报告
+   *
+   * 有按钮过渡时发过渡(带最新轴值);否则轴值相对上次发送
+   * 有变化且距上次发送满一个默认窗口时发轴更新
+   */
+  void gamepad_resampler_try_send(void);
+
+  /**
+   * @brief 获取统计信息(参数可为NULL)
+   */
+  void gamepad_resampler_get_stats(uint32_t *pending,
+                                   uint32_t *total_pushed,
+                                   uint32_t *total_sent,
+                                   uint32_t *total_coalesced,
+                                   uint32_t *total_failures);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GAMEPAD_RESAMPLER_H__ */
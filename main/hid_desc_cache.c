@@ -0,0 +1,184 @@
+/*
+ * HID Descriptor Parse Cache - Implementation File
+ *
+ * 核心逻辑:
+ * - key: 原始descriptor的64位FNV-1a哈希(取56位转成NVS key字符串)
+ * - value: 头部(magic/长度/完整哈希) + 解析结果blob
+ * - 读取时校验magic、descriptor长度和完整哈希,防止截断哈希碰撞和格式变更
+ */
+
+#include "hid_desc_cache.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include <string.h>
+#include <stdio.h>
+
+static const char *TAG = "HID_DESC_CACHE";
+
+// NVS命名空间
+#define CACHE_NAMESPACE "hid_desc"
+
+// blob格式版本magic: 格式变更时改这个值,旧条目自动失效
+#define CACHE_MAGIC 0x48444331 // "HDC1"
+
+static nvs_handle_t s_nvs = 0;
+static bool s_nvs_ready = false;
+
+// 持久化的blob头部(后面紧跟layout_count个hid_report_layout_t)
+typedef struct
+{
+  uint32_t magic;
+  uint32_t desc_len;
+  uint64_t desc_hash;
+  uint8_t desc_check_success;
+  uint8_t is_keyboard;
+  uint8_t is_mouse;
+  uint8_t layout_count;
+} cache_blob_header_t;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+/**
+ * @brief 64位FNV-1a哈希
+ */
+static uint64_t fnv1a_hash64(const uint8_t *data, size_t len)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < len; i++)
+  {
+    hash ^= data[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief 由descriptor哈希生成NVS key(NVS key最长15字符,取56位哈希)
+ */
+static void make_key(uint64_t hash, char *key, size_t key_size)
+{
+  snprintf(key, key_size, "h%014llx", (unsigned long long)(hash & 0x00FFFFFFFFFFFFFFULL));
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+esp_err_t hid_desc_cache_init(void)
+{
+  esp_err_t ret = nvs_open(CACHE_NAMESPACE, NVS_READWRITE, &s_nvs);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG, "打开NVS命名空间失败: %s, 缓存降级为禁用", esp_err_to_name(ret));
+    s_nvs_ready = false;
+    return ret;
+  }
+
+  s_nvs_ready = true;
+  ESP_LOGI(TAG, "HID descriptor缓存已就绪(命名空间: %s)", CACHE_NAMESPACE);
+  return ESP_OK;
+}
+
+bool hid_desc_cache_lookup(const uint8_t *desc, size_t desc_len, hid_desc_cache_entry_t *out)
+{
+  if (!s_nvs_ready || desc == NULL || desc_len == 0 || out == NULL)
+  {
+    return false;
+  }
+
+  uint64_t hash = fnv1a_hash64(desc, desc_len);
+  char key[16];
+  make_key(hash, key, sizeof(key));
+
+  // 先查大小,再读blob
+  size_t blob_size = 0;
+  esp_err_t ret = nvs_get_blob(s_nvs, key, NULL, &blob_size);
+  if (ret != ESP_OK)
+  {
+    return false; // 未命中
+  }
+
+  uint8_t blob[sizeof(cache_blob_header_t) + HID_DESC_CACHE_MAX_LAYOUTS * sizeof(hid_report_layout_t)];
+  if (blob_size < sizeof(cache_blob_header_t) || blob_size > sizeof(blob))
+  {
+    ESP_LOGW(TAG, "缓存条目大小异常(%zu字节),忽略", blob_size);
+    return false;
+  }
+
+  ret = nvs_get_blob(s_nvs, key, blob, &blob_size);
+  if (ret != ESP_OK)
+  {
+    return false;
+  }
+
+  cache_blob_header_t header;
+  memcpy(&header, blob, sizeof(header));
+
+  // 校验: 格式版本 + descriptor长度 + 完整64位哈希(防止56位key碰撞)
+  if (header.magic != CACHE_MAGIC ||
+      header.desc_len != desc_len ||
+      header.desc_hash != hash ||
+      header.layout_count > HID_DESC_CACHE_MAX_LAYOUTS ||
+      blob_size != sizeof(header) + header.layout_count * sizeof(hid_report_layout_t))
+  {
+    ESP_LOGW(TAG, "缓存条目校验失败,忽略(magic=0x%08lx, len=%lu)",
+             (unsigned long)header.magic, (unsigned long)header.desc_len);
+    return false;
+  }
+
+  out->desc_check_success = header.desc_check_success != 0;
+  out->is_keyboard = header.is_keyboard != 0;
+  out->is_mouse = header.is_mouse != 0;
+  out->layout_count = header.layout_count;
+  memcpy(out->layouts, blob + sizeof(header), header.layout_count * sizeof(hid_report_layout_t));
+
+  ESP_LOGI(TAG, "缓存命中: key=%s, keyboard=%d, mouse=%d, layouts=%d",
+           key, out->is_keyboard, out->is_mouse, out->layout_count);
+  return true;
+}
+
+esp_err_t hid_desc_cache_store(const uint8_t *desc, size_t desc_len, const hid_desc_cache_entry_t *entry)
+{
+  if (!s_nvs_ready || desc == NULL || desc_len == 0 || entry == NULL ||
+      entry->layout_count > HID_DESC_CACHE_MAX_LAYOUTS)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint64_t hash = fnv1a_hash64(desc, desc_len);
+  char key[16];
+  make_key(hash, key, sizeof(key));
+
+  cache_blob_header_t header = {
+      .magic = CACHE_MAGIC,
+      .desc_len = (uint32_t)desc_len,
+      .desc_hash = hash,
+      .desc_check_success = entry->desc_check_success ? 1 : 0,
+      .is_keyboard = entry->is_keyboard ? 1 : 0,
+      .is_mouse = entry->is_mouse ? 1 : 0,
+      .layout_count = entry->layout_count};
+
+  uint8_t blob[sizeof(cache_blob_header_t) + HID_DESC_CACHE_MAX_LAYOUTS * sizeof(hid_report_layout_t)];
+  size_t blob_size = sizeof(header) + entry->layout_count * sizeof(hid_report_layout_t);
+  memcpy(blob, &header, sizeof(header));
+  memcpy(blob + sizeof(header), entry->layouts, entry->layout_count * sizeof(hid_report_layout_t));
+
+  esp_err_t ret = nvs_set_blob(s_nvs, key, blob, blob_size);
+  if (ret == ESP_OK)
+  {
+    ret = nvs_commit(s_nvs);
+  }
+
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG, "写入缓存失败: %s", esp_err_to_name(ret));
+  }
+  else
+  {
+    ESP_LOGI(TAG, "缓存已写入: key=%s (%zu字节)", key, blob_size);
+  }
+  return ret;
+}
@@ -0,0 +1,72 @@
+/*
+ * HID Descriptor Parse Cache - Header File
+ *
+ * 核心思想:
+ * - 设备枚举时的descriptor解析+类型探测结果持久化到NVS
+ * - 以原始descriptor的FNV-1a哈希作为key,同一型号设备重新插入时直接命中
+ * - KVM场景频繁插拔时跳过整个解析/探测流程,缩短首个报告的就绪时间
+ */
+
+#ifndef HID_DESC_CACHE_H__
+#define HID_DESC_CACHE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "hid_report_parser_c.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 缓存条目中保存的最大layout数(与hid_host_example的MAX_MOUSE_LAYOUTS一致)
+#define HID_DESC_CACHE_MAX_LAYOUTS 16
+
+  /**
+   * @brief 一个descriptor对应的缓存解析结果
+   */
+  typedef struct
+  {
+    bool desc_check_success; // hid_device_type_detect的返回值
+    bool is_keyboard;        // 类型探测: 键盘
+    bool is_mouse;           // 类型探测: 鼠标
+    uint8_t layout_count;    // 解析出的鼠标layout数量(键盘为0)
+    hid_report_layout_t layouts[HID_DESC_CACHE_MAX_LAYOUTS];
+  } hid_desc_cache_entry_t;
+
+  /**
+   * @brief 初始化缓存模块(打开NVS命名空间)
+   *
+   * 需在nvs_flash_init()之后调用
+   *
+   * @return ESP_OK 成功,其他值表示失败(失败时lookup/store自动降级为未命中)
+   */
+  esp_err_t hid_desc_cache_init(void);
+
+  /**
+   * @brief 查询descriptor对应的缓存条目
+   *
+   * @param desc 原始HID report descriptor
+   * @param desc_len descriptor长度(字节)
+   * @param out 输出缓存条目
+   * @return true 命中, false 未命中(或缓存不可用)
+   */
+  bool hid_desc_cache_lookup(const uint8_t *desc, size_t desc_len, hid_desc_cache_entry_t *out);
+
+  /**
+   * @brief 写入descriptor的解析结果到缓存
+   *
+   * @param desc 原始HID report descriptor
+   * @param desc_len descriptor长度(字节)
+   * @param entry 要缓存的解析结果
+   * @return ESP_OK 成功,其他值表示失败
+   */
+  esp_err_t hid_desc_cache_store(const uint8_t *desc, size_t desc_len, const hid_desc_cache_entry_t *entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HID_DESC_CACHE_H__ */
@@ -10,12 +10,18 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include "esp_log.h"
+#include "deferred_log.h"
+#include "hot_path.h"
+#include "perf_probe.h"
 #include "hidd_le_prf_int.h" // 包含HID_RPT_ID_MOUSE_IN和HID_REPORT_TYPE_INPUT定义
 
 static hid_report_map_t *hid_dev_rpt_tbl;
 static uint8_t hid_dev_rpt_tbl_Len;
 
-static hid_report_map_t *hid_dev_rpt_by_id(uint8_t id, uint8_t type)
+// GATT拥塞状态(由BTC任务的ESP_GATTS_CONGEST_EVT写入,发送任务读取)
+static volatile bool hid_dev_congested = false;
+
+static hid_report_map_t *HOT_PATH_IRAM_ATTR hid_dev_rpt_by_id(uint8_t id, uint8_t type)
 {
   hid_report_map_t *rpt = hid_dev_rpt_tbl;
 
@@ -34,9 +40,56 @@ void hid_dev_register_reports(uint8_t num_reports, hid_report_map_t *p_report)
 {
   hid_dev_rpt_tbl = p_report;
   hid_dev_rpt_tbl_Len = num_reports;
+
+  // 初始化通知缓存：客户端还没写入CCCD，状态未知
+  for (uint8_t i = 0; i < num_reports; i++)
+  {
+    p_report[i].notifyState = HID_DEV_NOTIFY_UNKNOWN;
+  }
   return;
 }
 
+void hid_dev_cccd_write_handler(uint16_t cccd_handle, uint16_t cccd_value)
+{
+  hid_report_map_t *rpt = hid_dev_rpt_tbl;
+
+  if (cccd_handle == 0)
+  {
+    return;
+  }
+
+  for (uint8_t i = hid_dev_rpt_tbl_Len; i > 0; i--, rpt++)
+  {
+    if (rpt->cccdHandle == cccd_handle)
+    {
+      rpt->notifyState = (cccd_value & 0x0001) ? HID_DEV_NOTIFY_ENABLED : HID_DEV_NOTIFY_DISABLED;
+      ESP_LOGD(HID_LE_PRF_TAG, "CCCD缓存已更新: cccd_handle=%d, report_id=%d, 通知%s",
+               cccd_handle, rpt->id, (cccd_value & 0x0001) ? "已启用" : "已禁用");
+      // 不break：Boot/Report模式的条目可能共享同一CCCD handle
+    }
+  }
+}
+
+void hid_dev_reset_notify_cache(void)
+{
+  hid_report_map_t *rpt = hid_dev_rpt_tbl;
+
+  for (uint8_t i = hid_dev_rpt_tbl_Len; i > 0; i--, rpt++)
+  {
+    rpt->notifyState = HID_DEV_NOTIFY_UNKNOWN;
+  }
+}
+
+void hid_dev_set_congested(bool congested)
+{
+  hid_dev_congested = congested;
+}
+
+bool HOT_PATH_IRAM_ATTR hid_dev_is_congested(void)
+{
+  return hid_dev_congested;
+}
+
 /**
  * @brief Send HID report to the peer device
  *
@@ -47,143 +100,42 @@ void hid_dev_register_reports(uint8_t num_reports, hid_report_map_t *p_report)
  * @param length Report length
  * @param data Report data
  */
-esp_err_t hid_dev_send_report(esp_gatt_if_t gatts_if, uint16_t conn_id,
-                              uint8_t id, uint8_t type, uint8_t length, uint8_t *data)
+esp_err_t HOT_PATH_IRAM_ATTR hid_dev_send_report(esp_gatt_if_t gatts_if, uint16_t conn_id,
+                                                 uint8_t id, uint8_t type, uint8_t length, uint8_t *data)
 {
   hid_report_map_t *p_rpt;
 
+  PERF_PROBE_BEGIN();
+
   // get att handle for report
   if ((p_rpt = hid_dev_rpt_by_id(id, type)) != NULL)
   {
-    // 检查通知是否已启用（通过读取CCCD值）
+    // 检查通知是否已启用（使用缓存的CCCD状态，避免每个报告都查询BLE栈属性表）
+    // 缓存由hid_dev_cccd_write_handler()在GATT写事件中更新
     // 如果CCCD handle为0，说明是输出报告或特征报告，不需要检查通知
-    if (p_rpt->cccdHandle != 0)
+    // UNKNOWN状态（客户端还没写入CCCD，服务发现阶段）仍然尝试发送，
+    // 某些客户端可能不会写入CCCD但仍然可以接收通知
+    if (p_rpt->cccdHandle != 0 && p_rpt->notifyState == HID_DEV_NOTIFY_DISABLED)
     {
-      uint16_t cccd_len = 0;
-      const uint8_t *cccd_value_ptr = NULL;
-      esp_err_t get_ret = esp_ble_gatts_get_attr_value(p_rpt->cccdHandle, &cccd_len, &cccd_value_ptr);
-
-      // 如果无法获取CCCD值，记录警告但继续尝试发送（客户端可能还在配置中）
-      if (get_ret != ESP_OK)
-      {
-        ESP_LOGW(HID_LE_PRF_TAG, "无法获取CCCD值: get_ret=%s, report_id=%d, type=%d, cccd_handle=%d",
-                 esp_err_to_name(get_ret), id, type, p_rpt->cccdHandle);
-        // 继续尝试发送，让底层BLE栈处理
-      }
-      // 如果CCCD长度为0，说明客户端还没有写入CCCD（还在服务发现阶段）
-      else if (cccd_len == 0)
-      {
-        ESP_LOGD(HID_LE_PRF_TAG, "CCCD尚未写入（客户端可能还在配置中）: report_id=%d, type=%d, cccd_handle=%d",
-                 id, type, p_rpt->cccdHandle);
-        // 继续尝试发送，某些客户端可能不会写入CCCD但仍然可以接收通知
-      }
-      // 如果CCCD长度有效，检查通知是否已启用
-      else if (cccd_len >= sizeof(uint16_t))
-      {
-        // 读取CCCD值（little-endian）
-        uint16_t cccd_value = cccd_value_ptr[0] | (cccd_value_ptr[1] << 8);
-        if ((cccd_value & 0x0001) == 0)
-        {
-          ESP_LOGW(HID_LE_PRF_TAG, "通知已禁用: cccd_value=0x%04X, report_id=%d, type=%d, cccd_handle=%d",
-                   cccd_value, id, type, p_rpt->cccdHandle);
-          return ESP_ERR_INVALID_STATE; // 通知已明确禁用
-        }
-      }
+      ESP_LOGD(HID_LE_PRF_TAG, "通知已禁用: report_id=%d, type=%d, cccd_handle=%d",
+               id, type, p_rpt->cccdHandle);
+      return ESP_ERR_INVALID_STATE; // 通知已明确禁用
     }
 
     // if notifications are enabled
     // ESP_LOGI(HID_LE_PRF_TAG, "发送报告: handle=%d, report_id=%d, type=%d, length=%d",
     //          p_rpt->handle, id, type, length);
     esp_err_t ret = esp_ble_gatts_send_indicate(gatts_if, conn_id, p_rpt->handle, length, data, false);
+    PERF_PROBE_END(PERF_STAGE_BLE_NOTIFY);
     if (ret != ESP_OK)
     {
-      ESP_LOGW(HID_LE_PRF_TAG, "发送报告失败: %s, handle=%d, report_id=%d, type=%d",
-               esp_err_to_name(ret), p_rpt->handle, id, type);
+      // 发送路径在ble_tx任务的节拍里,不能阻塞UART,诊断走延迟日志
+      DLOGW4(HID_LE_PRF_TAG, "发送报告失败: err=0x%x, handle=%d, report_id=%d, type=%d",
+             ret, p_rpt->handle, id, type);
     }
     return ret;
   }
 
-  ESP_LOGW(HID_LE_PRF_TAG, "✗ 未找到报告映射: report_id=%d, type=%d", id, type);
+  DLOGW2(HID_LE_PRF_TAG, "未找到报告映射: report_id=%d, type=%d", id, type);
   return ESP_ERR_NOT_FOUND;
 }
-
-void hid_consumer_build_report(uint8_t *buffer, consumer_cmd_t cmd)
-{
-  if (!buffer)
-  {
-    ESP_LOGE(HID_LE_PRF_TAG, "%s(), the buffer is NULL, hid build report failed.", __func__);
-    return;
-  }
-
-  switch (cmd)
-  {
-  case HID_CONSUMER_CHANNEL_UP:
-    HID_CC_RPT_SET_CHANNEL(buffer, HID_CC_RPT_CHANNEL_UP);
-    break;
-
-  case HID_CONSUMER_CHANNEL_DOWN:
-    HID_CC_RPT_SET_CHANNEL(buffer, HID_CC_RPT_CHANNEL_DOWN);
-    break;
-
-  case HID_CONSUMER_VOLUME_UP:
-    HID_CC_RPT_SET_VOLUME_UP(buffer);
-    break;
-
-  case HID_CONSUMER_VOLUME_DOWN:
-    HID_CC_RPT_SET_VOLUME_DOWN(buffer);
-    break;
-
-  case HID_CONSUMER_MUTE:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_MUTE);
-    break;
-
-  case HID_CONSUMER_POWER:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_POWER);
-    break;
-
-  case HID_CONSUMER_RECALL_LAST:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_LAST);
-    break;
-
-  case HID_CONSUMER_ASSIGN_SEL:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_ASSIGN_SEL);
-    break;
-
-  case HID_CONSUMER_PLAY:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_PLAY);
-    break;
-
-  case HID_CONSUMER_PAUSE:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_PAUSE);
-    break;
-
-  case HID_CONSUMER_RECORD:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_RECORD);
-    break;
-
-  case HID_CONSUMER_FAST_FORWARD:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_FAST_FWD);
-    break;
-
-  case HID_CONSUMER_REWIND:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_REWIND);
-    break;
-
-  case HID_CONSUMER_SCAN_NEXT_TRK:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_SCAN_NEXT_TRK);
-    break;
-
-  case HID_CONSUMER_SCAN_PREV_TRK:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_SCAN_PREV_TRK);
-    break;
-
-  case HID_CONSUMER_STOP:
-    HID_CC_RPT_SET_BUTTON(buffer, HID_CC_RPT_STOP);
-    break;
-
-  default:
-    break;
-  }
-
-  return;
-}
@@ -8,6 +8,8 @@
 #include <string.h>
 #include <stdio.h>
 #include "esp_log.h"
+#include "hid_dev.h"
+#include "mouse_accumulator.h"
 
 // 配置选项：使用16位精度（1）或8位精度（0）
 // 注意：Report Map 中 X/Y 定义为 16bit 以兼容 8bit 和 16bit
@@ -19,9 +21,9 @@
 #endif
 
 // HID mouse input report length (必须与esp_hidd_prf_api.c和hid_host_example.c保持一致)
-// 基于 report map: 按钮(1字节: 5位按钮+3位padding) + X(2字节, 16bit) + Y(2字节, 16bit) + Wheel(1字节) = 6字节
-// 注意：即使发送 8bit 数据，报告长度仍为 6 字节（8bit 数据放在 16bit 字段的低 8 位）
-#define HID_MOUSE_IN_RPT_LEN 6 // 按钮(1) + X(2) + Y(2) + Wheel(1) = 6字节（兼容 8bit 和 16bit）
+// 基于 report map: 按钮(1字节: 5位按钮+3位padding) + X(2字节, 16bit) + Y(2字节, 16bit) + Wheel(1字节) + AC Pan(1字节) = 7字节
+// 注意：即使发送 8bit 数据，报告长度仍为 7 字节（8bit 数据放在 16bit 字段的低 8 位）
+#define HID_MOUSE_IN_RPT_LEN 7 // 按钮(1) + X(2) + Y(2) + Wheel(1) + AC Pan(1) = 7字节（兼容 8bit 和 16bit）
 
 /// characteristic presentation information
 struct prf_char_pres_fmt
@@ -103,38 +105,15 @@ static const uint8_t hidReportMap[] = {
     0xA1, 0x01, // Collection (Application)
     0x85, 0x02, // Report Id (2)
 
-    0x05, 0x0C, //   Usage Pg (Consumer Devices)
-    0x09, 0x86, //   Usage (Channel)
-    0x15, 0xFF, //   Logical Min (-1)
-    0x25, 0x01, //   Logical Max (1)
-    0x75, 0x02, //   Report Size (2)
-    0x95, 0x01, //   Report Count (1)
-    0x81, 0x46, //   Input (Data, Var, Rel, Null)
-
-    0x09, 0xE9, //   Usage (Volume Up)
-    0x09, 0xEA, //   Usage (Volume Down)
-    0x15, 0x00, //   Logical Min (0)
-    0x75, 0x01, //   Report Size (1)
-    0x95, 0x02, //   Report Count (2)
-    0x81, 0x02, //   Input (Data, Var, Abs)
-
-    0x09, 0xE2, //   Usage (Mute)
-    0x09, 0x30, //   Usage (Power)
-    0x09, 0x83, //   Usage (Recall Last)
-    0x09, 0x81, //   Usage (Assign Selection)
-    0x09, 0xB0, //   Usage (Play)
-    0x09, 0xB1, //   Usage (Pause)
-    0x09, 0xB2, //   Usage (Record)
-    0x09, 0xB3, //   Usage (Fast Forward)
-    0x09, 0xB4, //   Usage (Rewind)
-    0x09, 0xB5, //   Usage (Scan Next)
-    0x09, 0xB6, //   Usage (Scan Prev)
-    0x09, 0xB7, //   Usage (Stop)
-    0x15, 0x01, //   Logical Min (1)
-    0x25, 0x0C, //   Logical Max (12)
-    0x75, 0x04, //   Report Size (4)
-    0x95, 0x01, //   Report Count (1)
-    0x81, 0x00, //   Input (Data, Ary, Abs)
+    // 16位usage数组: 任意Consumer Page usage直接作为槽值上报,
+    // 0表示全部释放;新usage无需改动report map
+    0x15, 0x00,       //   Logical Min (0)
+    0x26, 0xFF, 0x02, //   Logical Max (0x2FF)
+    0x19, 0x00,       //   Usage Min (0)
+    0x2A, 0xFF, 0x02, //   Usage Max (0x2FF)
+    0x75, 0x10,       //   Report Size (16)
+    0x95, 0x01,       //   Report Count (1)
+    0x81, 0x00,       //   Input (Data, Ary, Abs)
 
     0xC0, // End Collection
 
@@ -181,6 +160,15 @@ static const uint8_t hidReportMap[] = {
     0x95, 0x01, //     Report Count (1)
     0x81, 0x06, //     Input (Data, Variable, Relative)
 
+    // AC Pan (水平滚轮/倾斜滚轮) 8-bit signed: -127..127
+    0x05, 0x0C,       //     Usage Page (Consumer)
+    0x0A, 0x38, 0x02, //     Usage (AC Pan)
+    0x15, 0x81,       //     Logical Minimum (-127)
+    0x25, 0x7F,       //     Logical Maximum (127)
+    0x75, 0x08,       //     Report Size (8)
+    0x95, 0x01,       //     Report Count (1)
+    0x81, 0x06,       //     Input (Data, Variable, Relative)
+
     0xC0, //   End Collection
     0xC0, // End Collection
 
@@ -226,6 +214,37 @@ static const uint8_t hidReportMap[] = {
     0xC0, // End Collection
 #endif
 
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+    // ================= NKRO Keyboard (Report ID 6) =================
+    // 位图键盘: 每个键1bit,没有6键滚转限制
+    0x05, 0x01, // Usage Pg (Generic Desktop)
+    0x09, 0x06, // Usage (Keyboard)
+    0xA1, 0x01, // Collection: (Application)
+    0x85, 0x06, // Report Id (6)
+
+    // Modifier byte (与Report ID 1相同的E0..E7位图)
+    0x05, 0x07, //   Usage Pg (Key Codes)
+    0x19, 0xE0, //   Usage Min (224) - Left Control
+    0x29, 0xE7, //   Usage Max (231) - Right GUI
+    0x15, 0x00, //   Log Min (0)
+    0x25, 0x01, //   Log Max (1)
+    0x75, 0x01, //   Report Size (1)
+    0x95, 0x08, //   Report Count (8)
+    0x81, 0x02, //   Input: (Data, Variable, Absolute) - Modifier byte
+
+    // Key bitmap: Usage 0x00..0x77, 120 bits = 15字节
+    0x05, 0x07, //   Usage Pg (Key Codes)
+    0x19, 0x00, //   Usage Min (0)
+    0x29, 0x77, //   Usage Max (119)
+    0x15, 0x00, //   Log Min (0)
+    0x25, 0x01, //   Log Max (1)
+    0x75, 0x01, //   Report Size (1)
+    0x95, 0x78, //   Report Count (120)
+    0x81, 0x02, //   Input: (Data, Variable, Absolute) - Key bitmap
+
+    0xC0, // End Collection
+#endif
+
 #if (SUPPORT_REPORT_VENDOR == true)
     0x06, 0xFF, 0xFF, // Usage Page(Vendor defined)
     0x09, 0xA5,       // Usage(Vendor Defined)
@@ -316,6 +335,18 @@ static uint8_t hidReportRefFeature[HID_REPORT_REF_LEN] =
 static uint8_t hidReportRefCCIn[HID_REPORT_REF_LEN] =
     {HID_RPT_ID_CC_IN, HID_REPORT_TYPE_INPUT};
 
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+// HID Report Reference characteristic descriptor, NKRO keyboard input
+static uint8_t hidReportRefNkroIn[HID_REPORT_REF_LEN] =
+    {HID_RPT_ID_NKRO_IN, HID_REPORT_TYPE_INPUT};
+#endif
+
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+// HID Report Reference characteristic descriptor, gamepad input
+static uint8_t hidReportRefGamepadIn[HID_REPORT_REF_LEN] =
+    {HID_RPT_ID_GAMEPAD_IN, HID_REPORT_TYPE_INPUT};
+#endif
+
 /*
  *  Heart Rate PROFILE ATTRIBUTES
  ****************************************************************************************
@@ -446,6 +477,28 @@ static esp_gatts_attr_db_t hidd_le_gatt_db[HIDD_LE_IDX_NB] =
         // Report Characteristic - Report Reference Descriptor
         [HIDD_LE_IDX_REPORT_CC_IN_REP_REF] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&hid_report_ref_descr_uuid, ESP_GATT_PERM_READ, sizeof(hidReportRefCCIn), sizeof(hidReportRefCCIn), hidReportRefCCIn}},
 
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+        // Report Characteristic Declaration
+        [HIDD_LE_IDX_REPORT_NKRO_IN_CHAR] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ, CHAR_DECLARATION_SIZE, CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_notify}},
+        // Report Characteristic Value
+        [HIDD_LE_IDX_REPORT_NKRO_IN_VAL] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&hid_report_uuid, ESP_GATT_PERM_READ, HIDD_LE_REPORT_MAX_LEN, 0, NULL}},
+        // Report NKRO INPUT Characteristic - Client Characteristic Configuration Descriptor
+        [HIDD_LE_IDX_REPORT_NKRO_IN_CCC] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_client_config_uuid, (ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE), sizeof(uint16_t), 0, NULL}},
+        // Report Characteristic - Report Reference Descriptor
+        [HIDD_LE_IDX_REPORT_NKRO_IN_REP_REF] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&hid_report_ref_descr_uuid, ESP_GATT_PERM_READ, sizeof(hidReportRefNkroIn), sizeof(hidReportRefNkroIn), hidReportRefNkroIn}},
+#endif
+
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+        // Report Characteristic Declaration
+        [HIDD_LE_IDX_REPORT_GAMEPAD_IN_CHAR] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ, CHAR_DECLARATION_SIZE, CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_notify}},
+        // Report Characteristic Value
+        [HIDD_LE_IDX_REPORT_GAMEPAD_IN_VAL] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&hid_report_uuid, ESP_GATT_PERM_READ, HIDD_LE_REPORT_MAX_LEN, 0, NULL}},
+        // Report Gamepad INPUT Characteristic - Client Characteristic Configuration Descriptor
+        [HIDD_LE_IDX_REPORT_GAMEPAD_IN_CCC] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_client_config_uuid, (ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE), sizeof(uint16_t), 0, NULL}},
+        // Report Characteristic - Report Reference Descriptor
+        [HIDD_LE_IDX_REPORT_GAMEPAD_IN_REP_REF] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&hid_report_ref_descr_uuid, ESP_GATT_PERM_READ, sizeof(hidReportRefGamepadIn), sizeof(hidReportRefGamepadIn), hidReportRefGamepadIn}},
+#endif
+
         // Boot Keyboard Input Report Characteristic Declaration
         [HIDD_LE_IDX_BOOT_KB_IN_REPORT_CHAR] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ, CHAR_DECLARATION_SIZE, CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_notify}},
         // Boot Keyboard Input Report Characteristic Value
@@ -525,8 +578,29 @@ void esp_hidd_prf_cb_hdl(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
     }
     break;
   }
+  case ESP_GATTS_CONGEST_EVT:
+  {
+    // 控制器notify队列满/恢复,更新拥塞标志做流控
+    // 拥塞期间发送任务跳过notify,鼠标运动继续在ring buffer中无损积分
+    hid_dev_set_congested(param->congest.congested);
+    if (param->congest.congested)
+    {
+      ESP_LOGW(HID_LE_PRF_TAG, "GATT拥塞开始: conn_id=%d, 暂停BLE发送", param->congest.conn_id);
+    }
+    else
+    {
+      ESP_LOGI(HID_LE_PRF_TAG, "GATT拥塞解除: conn_id=%d, 立即恢复发送", param->congest.conn_id);
+      // 不等下一个定时器节拍,立即唤醒发送任务把积压的数据发出去
+      mouse_accumulator_request_send();
+    }
+    break;
+  }
   case ESP_GATTS_DISCONNECT_EVT:
   {
+    // 断开后CCCD订阅失效，重置通知缓存（重连后客户端会重新写入CCCD）
+    hid_dev_reset_notify_cache();
+    // 拥塞状态随连接一起消失,避免重连后卡在暂停状态
+    hid_dev_set_congested(false);
     if (hidd_le_env.hidd_cb != NULL)
     {
       (hidd_le_env.hidd_cb)(ESP_HIDD_EVENT_BLE_DISCONNECT, NULL);
@@ -546,19 +620,40 @@ void esp_hidd_prf_cb_hdl(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
       uint16_t cccd_value = param->write.value[0] | (param->write.value[1] << 8);
       ESP_LOGI(HID_LE_PRF_TAG, "键盘输入报告CCCD已写入: handle=%d, value=0x%04X, 通知%s",
                param->write.handle, cccd_value, (cccd_value & 0x0001) ? "已启用" : "已禁用");
+      hid_dev_cccd_write_handler(param->write.handle, cccd_value);
     }
     else if (param->write.handle == hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_MOUSE_IN_CCC])
     {
       uint16_t cccd_value = param->write.value[0] | (param->write.value[1] << 8);
       ESP_LOGI(HID_LE_PRF_TAG, "鼠标输入报告CCCD已写入: handle=%d, value=0x%04X, 通知%s",
                param->write.handle, cccd_value, (cccd_value & 0x0001) ? "已启用" : "已禁用");
+      hid_dev_cccd_write_handler(param->write.handle, cccd_value);
     }
     else if (param->write.handle == hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_CC_IN_CCC])
     {
       uint16_t cccd_value = param->write.value[0] | (param->write.value[1] << 8);
       ESP_LOGI(HID_LE_PRF_TAG, "Consumer Control输入报告CCCD已写入: handle=%d, value=0x%04X, 通知%s",
                param->write.handle, cccd_value, (cccd_value & 0x0001) ? "已启用" : "已禁用");
+      hid_dev_cccd_write_handler(param->write.handle, cccd_value);
     }
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+    else if (param->write.handle == hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_NKRO_IN_CCC])
+    {
+      uint16_t cccd_value = param->write.value[0] | (param->write.value[1] << 8);
+      ESP_LOGI(HID_LE_PRF_TAG, "NKRO输入报告CCCD已写入: handle=%d, value=0x%04X, 通知%s",
+               param->write.handle, cccd_value, (cccd_value & 0x0001) ? "已启用" : "已禁用");
+      hid_dev_cccd_write_handler(param->write.handle, cccd_value);
+    }
+#endif
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+    else if (param->write.handle == hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_GAMEPAD_IN_CCC])
+    {
+      uint16_t cccd_value = param->write.value[0] | (param->write.value[1] << 8);
+      ESP_LOGI(HID_LE_PRF_TAG, "Gamepad输入报告CCCD已写入: handle=%d, value=0x%04X, 通知%s",
+               param->write.handle, cccd_value, (cccd_value & 0x0001) ? "已启用" : "已禁用");
+      hid_dev_cccd_write_handler(param->write.handle, cccd_value);
+    }
+#endif
 
     if (param->write.handle == hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_LED_OUT_VAL])
     {
@@ -636,13 +731,17 @@ void esp_hidd_prf_cb_hdl(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
 #else
       ESP_LOGI(HID_LE_PRF_TAG, "  - Report ID 4: Vendor Output (已启用)");
 #endif
+#endif
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+      ESP_LOGI(HID_LE_PRF_TAG, "  - Report ID 6: NKRO Keyboard (16字节: Modifier + 120键位图)");
 #endif
       ESP_LOGI(HID_LE_PRF_TAG, "鼠标报告结构 (Report ID 3):");
       ESP_LOGI(HID_LE_PRF_TAG, "  - 按钮: 5位 (Button1~5，支持侧键) + 3位padding = 1字节 (字节0)");
       ESP_LOGI(HID_LE_PRF_TAG, "  - X: 16位 = 2字节 (字节1-2, little-endian, 兼容 8bit 和 16bit)");
       ESP_LOGI(HID_LE_PRF_TAG, "  - Y: 16位 = 2字节 (字节3-4, little-endian, 兼容 8bit 和 16bit)");
       ESP_LOGI(HID_LE_PRF_TAG, "  - Wheel: 8位 = 1字节 (字节5)");
-      ESP_LOGI(HID_LE_PRF_TAG, "  - 总计: 6字节 (48位)");
+      ESP_LOGI(HID_LE_PRF_TAG, "  - AC Pan: 8位 = 1字节 (字节6, 水平滚轮)");
+      ESP_LOGI(HID_LE_PRF_TAG, "  - 总计: 7字节 (56位)");
       ESP_LOGI(HID_LE_PRF_TAG, "  - USE_16BIT_MOUSE_PRECISION = %d (发送 %s 数据)",
                USE_16BIT_MOUSE_PRECISION,
                USE_16BIT_MOUSE_PRECISION ? "16bit" : "8bit (放在16bit字段中)");
@@ -855,6 +954,24 @@ static void hid_add_id_tbl(void)
   hid_rpt_map[7].cccdHandle = 0;
   hid_rpt_map[7].mode = HID_PROTOCOL_MODE_REPORT;
 
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+  // NKRO keyboard input report
+  hid_rpt_map[8].id = hidReportRefNkroIn[0];
+  hid_rpt_map[8].type = hidReportRefNkroIn[1];
+  hid_rpt_map[8].handle = hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_NKRO_IN_VAL];
+  hid_rpt_map[8].cccdHandle = hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_NKRO_IN_CCC];
+  hid_rpt_map[8].mode = HID_PROTOCOL_MODE_REPORT;
+#endif
+
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+  // Gamepad input report
+  hid_rpt_map[9].id = hidReportRefGamepadIn[0];
+  hid_rpt_map[9].type = hidReportRefGamepadIn[1];
+  hid_rpt_map[9].handle = hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_GAMEPAD_IN_VAL];
+  hid_rpt_map[9].cccdHandle = hidd_le_env.hidd_inst.att_tbl[HIDD_LE_IDX_REPORT_GAMEPAD_IN_CCC];
+  hid_rpt_map[9].mode = HID_PROTOCOL_MODE_REPORT;
+#endif
+
   // Setup report ID map
   hid_dev_register_reports(HID_NUM_REPORTS, hid_rpt_map);
 }
@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -38,8 +39,22 @@
 #include "hid_dev.h"
 #include "hid_report_parser_c.h"
 #include "hid_device_type_detector.h"
+#include "hid_desc_cache.h"
 #include "hid_host_example.h"
 #include "mouse_accumulator.h"
+#include "keyboard_queue.h"
+#include "nkro_keyboard.h"
+#include "conn_params.h"
+#include "power_mgmt.h"
+#include "input_bench.h"
+#include "deferred_log.h"
+#include "ble_reconnect.h"
+#include "report_pool.h"
+#include "report_worker.h"
+#include "gamepad_resampler.h"
+#include "consumer_pipeline.h"
+#include "perf_probe.h"
+#include "hot_path.h"
 #include "led_control.h"
 
 /* =================================================================================================
@@ -54,9 +69,9 @@
 // 注意：此宏必须与hid_device_le_prf.c和esp_hidd_prf_api.c中的定义保持一致
 #define USE_16BIT_MOUSE_PRECISION 1
 
-// 基于 Zephyr report map: 按钮(1字节: 3位按钮+5位padding) + X(2字节, 16bit) + Y(2字节, 16bit) + Wheel(1字节) = 6字节
-// 注意：即使发送 8bit 数据，报告长度仍为 6 字节（8bit 数据放在 16bit 字段的低 8 位）
-#define HID_MOUSE_IN_RPT_LEN 6 // 按钮(1) + X(2) + Y(2) + Wheel(1) = 6字节（兼容 8bit 和 16bit）
+// 基于 report map: 按钮(1字节: 5位按钮+3位padding) + X(2字节, 16bit) + Y(2字节, 16bit) + Wheel(1字节) + AC Pan(1字节) = 7字节
+// 注意：即使发送 8bit 数据，报告长度仍为 7 字节（8bit 数据放在 16bit 字段的低 8 位）
+#define HID_MOUSE_IN_RPT_LEN 7 // 按钮(1) + X(2) + Y(2) + Wheel(1) + AC Pan(1) = 7字节（兼容 8bit 和 16bit）
 #define HID_CC_IN_RPT_LEN 2
 #define BLE_HID_DEVICE_NAME "BLE HID"
 
@@ -145,7 +160,8 @@ QueueHandle_t app_event_queue = NULL;
 typedef enum
 {
   APP_EVENT = 0,
-  APP_EVENT_HID_HOST
+  APP_EVENT_HID_HOST,
+  APP_EVENT_LED_FORWARD // 唤醒事件循环下发暂存的键盘LED状态
 } app_event_group_t;
 
 /**
@@ -185,13 +201,310 @@ typedef struct
 
 static usb_hid_devices_t usb_hid_devices = {0};
 
-// Parsed layouts for the connected mouse reports (filled when descriptor is available)
+// 待下发的键盘LED状态(单槽去重: bit8=有效标志, 低8位=LED位图)
+// BLE回调只写这里并唤醒事件循环,USB控制传输由app_main任务执行,
+// 慢/卡死的键盘不再阻塞BLE栈的事件任务;中间状态被最新状态取代
+#define LED_PENDING_FLAG 0x100u
+static _Atomic uint32_t s_pending_led_state = 0;
+
+// Parsed layouts for connected mouse interfaces (filled when descriptor is available)
 #define MAX_MOUSE_LAYOUTS 16
-static hid_report_layout_t g_mouse_layouts[MAX_MOUSE_LAYOUTS];
-static int g_mouse_layout_count = 0;
-// 缓存当前使用的layout指针，避免每次循环查找
-static hid_report_layout_t *g_cached_layout = NULL;
-static uint8_t g_cached_report_id = 0xFF; // 0xFF表示未缓存
+// 同时支持的鼠标报告流数量(hub/复合设备场景)
+#define MAX_LAYOUT_TABLES 4
+
+// 每个USB接口一份layout表和热路径缓存,按设备句柄索引
+// 多个输入流(hub上的多只鼠标、发鼠标报告的复合键盘)互不干扰,
+// 交错的Report ID不再互相踢掉对方的缓存
+typedef struct
+{
+  hid_host_device_handle_t handle; // NULL表示空槽
+  hid_report_layout_t layouts[MAX_MOUSE_LAYOUTS];
+  // 预编译的提取计划（与layouts一一对应，枚举时编译）
+  hid_report_plan_t plans[MAX_MOUSE_LAYOUTS];
+  int layout_count;
+  // 缓存当前使用的layout/plan指针，避免每个报告都线性查找
+  hid_report_layout_t *cached_layout;
+  hid_report_plan_t *cached_plan;
+  uint8_t cached_report_id; // 0xFF表示未缓存
+  // O(1)分发表(枚举时构建): 按report_id直接索引出类别和layout下标,
+  // 热路径不再做长度启发式和线性查找
+  uint8_t dispatch_route[256];  // hid_report_id_class_t
+  int8_t dispatch_layout[256];  // 鼠标类报告对应的layouts/plans下标,-1表示无
+  uint8_t route_no_id;          // 描述符没有report_id时的路由
+  int8_t layout_no_id;          // 同上,对应的layout下标
+  bool has_report_ids;          // 描述符是否使用report_id(决定data[0]怎么解释)
+  bool dispatch_built;          // 分发表已构建(未构建时走原有的协议字段路由)
+} mouse_layout_table_t;
+
+static mouse_layout_table_t g_layout_tables[MAX_LAYOUT_TABLES];
+// 最近命中的表(单设备场景下一次指针比较即可定位)
+static mouse_layout_table_t *g_last_table = NULL;
+
+// 手柄重采样器当前归属的设备句柄(同一时刻只桥接一只手柄)
+static hid_host_device_handle_t s_gamepad_owner = NULL;
+
+// 消费类管线当前归属的设备句柄(同一时刻只按一台设备的布局提取)
+static hid_host_device_handle_t s_consumer_owner = NULL;
+
+/**
+ * @brief 查找句柄对应的layout表
+ */
+static mouse_layout_table_t *HOT_PATH_IRAM_ATTR layout_table_find(hid_host_device_handle_t handle)
+{
+  if (handle == NULL)
+  {
+    return NULL;
+  }
+  if (g_last_table != NULL && g_last_table->handle == handle)
+  {
+    return g_last_table;
+  }
+  for (int i = 0; i < MAX_LAYOUT_TABLES; i++)
+  {
+    if (g_layout_tables[i].handle == handle)
+    {
+      g_last_table = &g_layout_tables[i];
+      return g_last_table;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief 为句柄分配(或复用)一个layout表,满时返回NULL
+ */
+static mouse_layout_table_t *layout_table_alloc(hid_host_device_handle_t handle)
+{
+  mouse_layout_table_t *t = layout_table_find(handle);
+  if (t == NULL)
+  {
+    for (int i = 0; i < MAX_LAYOUT_TABLES; i++)
+    {
+      if (g_layout_tables[i].handle == NULL)
+      {
+        t = &g_layout_tables[i];
+        break;
+      }
+    }
+  }
+  if (t == NULL)
+  {
+    ESP_LOGW(TAG_MOUSE, "layout表已满(%d个),新设备将使用回退解析逻辑", MAX_LAYOUT_TABLES);
+    return NULL;
+  }
+  memset(t, 0, sizeof(*t));
+  t->handle = handle;
+  t->cached_report_id = 0xFF;
+  return t;
+}
+
+/**
+ * @brief 设备断开时释放layout表
+ */
+static void layout_table_release(hid_host_device_handle_t handle)
+{
+  mouse_layout_table_t *t = layout_table_find(handle);
+  bool had_mouse_layouts = false;
+  if (t != NULL)
+  {
+    had_mouse_layouts = (t->layout_count > 0);
+    memset(t, 0, sizeof(*t));
+    t->cached_report_id = 0xFF;
+  }
+  g_last_table = NULL;
+
+  // 滚轮分辨率倍率跟随鼠标设备,断开时恢复普通滚轮
+  // (新设备枚举时会按自己的descriptor重新设置;
+  //  键盘接口的分发表释放不碰鼠标的倍率)
+  if (had_mouse_layouts)
+  {
+    mouse_accumulator_set_wheel_divisor(1);
+  }
+
+  // 手柄设备断开: 取消重采样器配置(其他设备的表释放不影响)
+  if (s_gamepad_owner != NULL && s_gamepad_owner == handle)
+  {
+    gamepad_resampler_reset();
+    s_gamepad_owner = NULL;
+  }
+
+  // 消费类设备断开: 取消布局配置,管线回退到LE16直通
+  if (s_consumer_owner != NULL && s_consumer_owner == handle)
+  {
+    consumer_pipeline_reset();
+    s_consumer_owner = NULL;
+  }
+}
+
+/**
+ * @brief 枚举时构建O(1)报告分发表
+ *
+ * 报告ID集合在descriptor解析后就固定了,把"这个包怎么解释"的判断
+ * 全部前移到枚举阶段: 每个report_id直接索引出类别(鼠标/键盘/消费类/
+ * 手柄)和对应的layout下标,热路径一次数组访问完成路由,
+ * 不再按包长度猜协议、也不再线性扫描layout表。
+ * 消费类媒体键走独立report_id的设备由此能被正确转发而不是落进generic日志。
+ */
+static void dispatch_table_build(mouse_layout_table_t *t,
+                                 const uint8_t *report_desc, size_t report_desc_len)
+{
+  if (t == NULL || report_desc == NULL || report_desc_len == 0)
+  {
+    return;
+  }
+
+  memset(t->dispatch_route, HID_RID_CLASS_UNKNOWN, sizeof(t->dispatch_route));
+  memset(t->dispatch_layout, 0xFF, sizeof(t->dispatch_layout)); // 全部-1
+  t->route_no_id = HID_RID_CLASS_UNKNOWN;
+  t->layout_no_id = -1;
+  t->has_report_ids = false;
+
+  // 按Application Collection分类所有输入报告ID
+  hid_report_id_entry_t classes[HID_REPORT_ID_CLASS_MAX];
+  int class_count = parse_hid_report_id_classes(report_desc, report_desc_len,
+                                                classes, HID_REPORT_ID_CLASS_MAX);
+  for (int i = 0; i < class_count; i++)
+  {
+    if (classes[i].report_id != 0)
+    {
+      t->dispatch_route[classes[i].report_id] = classes[i].rid_class;
+      t->has_report_ids = true;
+    }
+    else
+    {
+      t->route_no_id = classes[i].rid_class;
+    }
+  }
+
+  // 鼠标layout挂到对应report_id的槽位(类别扫描没认出的也按鼠标路由,
+  // 与原有行为一致: 有layout就走plan提取)
+  for (int i = 0; i < t->layout_count && i < 127; i++)
+  {
+    uint8_t rid = t->layouts[i].report_id;
+    if (rid != 0)
+    {
+      if (t->dispatch_layout[rid] < 0)
+      {
+        t->dispatch_layout[rid] = (int8_t)i;
+      }
+      if (t->dispatch_route[rid] == HID_RID_CLASS_UNKNOWN)
+      {
+        t->dispatch_route[rid] = HID_RID_CLASS_MOUSE;
+      }
+      t->has_report_ids = true;
+    }
+    else if (t->layout_no_id < 0)
+    {
+      t->layout_no_id = (int8_t)i;
+      if (t->route_no_id == HID_RID_CLASS_UNKNOWN)
+      {
+        t->route_no_id = HID_RID_CLASS_MOUSE;
+      }
+    }
+  }
+
+  t->dispatch_built = true;
+
+  // 消费类报告: 解析usage位图/数组布局并配置转发管线
+  // (已有归属时后来的设备走未配置的直通回退)
+  for (int i = 0; i < class_count; i++)
+  {
+    if (classes[i].rid_class == HID_RID_CLASS_CONSUMER &&
+        (s_consumer_owner == NULL || s_consumer_owner == t->handle))
+    {
+      hid_consumer_layout_t cc_layout;
+      if (parse_hid_consumer_layout(report_desc, report_desc_len, &cc_layout) == 0 &&
+          consumer_pipeline_configure(&cc_layout))
+      {
+        s_consumer_owner = t->handle;
+      }
+      break;
+    }
+  }
+
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+  // 手柄类报告: 解析轴/帽/按钮布局并配置重采样器
+  // (同一时刻只桥接一只手柄,已有归属时后来的设备走generic)
+  for (int i = 0; i < class_count; i++)
+  {
+    if (classes[i].rid_class == HID_RID_CLASS_GAMEPAD &&
+        (s_gamepad_owner == NULL || s_gamepad_owner == t->handle))
+    {
+      hid_gamepad_layout_t pad_layout;
+      if (parse_hid_gamepad_layout(report_desc, report_desc_len, &pad_layout) == 0 &&
+          gamepad_resampler_configure(&pad_layout))
+      {
+        s_gamepad_owner = t->handle;
+      }
+      break;
+    }
+  }
+#endif
+
+  for (int i = 0; i < class_count; i++)
+  {
+    static const char *route_names[] = {"generic", "mouse", "keyboard", "consumer", "gamepad"};
+    uint8_t cls = classes[i].rid_class;
+    ESP_LOGI(TAG_HID, "分发表: report_id=%u -> %s%s", classes[i].report_id,
+             (cls <= HID_RID_CLASS_GAMEPAD) ? route_names[cls] : "?",
+             (classes[i].report_id != 0 && t->dispatch_layout[classes[i].report_id] >= 0) ? " (已编译plan)" : "");
+  }
+}
+
+/**
+ * @brief 尝试启用高分辨率滚轮(Resolution Multiplier feature)
+ *
+ * descriptor里声明了Resolution Multiplier的鼠标,上电默认工作在
+ * 普通detent模式;SET_FEATURE写入logical_max后滚轮按hi-res计数上报。
+ * 启用成功时把倍率告知累加器,积分后除以倍率发整detent,
+ * 分数detent经残差机制跨窗口累积,滚动更顺滑且不损失距离。
+ */
+static void mouse_enable_hires_scroll(hid_host_device_handle_t hid_device_handle,
+                                      const uint8_t *report_desc, size_t report_desc_len)
+{
+  hid_res_multiplier_t mult;
+  if (report_desc == NULL || report_desc_len == 0 ||
+      parse_hid_resolution_multiplier(report_desc, report_desc_len, &mult) != 0)
+  {
+    return; // 没有multiplier feature: 普通滚轮,倍率保持1
+  }
+
+  // 构建feature报告: 每个multiplier字段写入logical_max,其余位保持0
+  uint8_t buf[8] = {0};
+  size_t len = (mult.report_size_bits + 7) / 8;
+  if (len == 0 || len > sizeof(buf))
+  {
+    ESP_LOGW(TAG_MOUSE, "Resolution Multiplier feature报告长度异常(%u位),跳过",
+             (unsigned int)mult.report_size_bits);
+    return;
+  }
+  for (int f = 0; f < mult.field_count; f++)
+  {
+    for (uint32_t b = 0; b < mult.sizes[f] && b < 32; b++)
+    {
+      if ((uint32_t)mult.logical_max & (1u << b))
+      {
+        uint32_t bit = mult.bit_offsets[f] + b;
+        buf[bit / 8] |= (uint8_t)(1u << (bit % 8));
+      }
+    }
+  }
+
+  esp_err_t ret = hid_class_request_set_report(hid_device_handle, HID_REPORT_TYPE_FEATURE,
+                                               mult.report_id, buf, len);
+  if (ret == ESP_OK)
+  {
+    uint8_t divisor = (mult.effective > 255) ? 255 : (uint8_t)mult.effective;
+    mouse_accumulator_set_wheel_divisor(divisor);
+    ESP_LOGI(TAG_MOUSE, "高分辨率滚轮已启用: feature报告ID=%u, 字段数=%d, 倍率=%u",
+             mult.report_id, mult.field_count, divisor);
+  }
+  else
+  {
+    // SET_FEATURE被拒: 设备仍在detent模式,倍率保持1即可正常工作
+    ESP_LOGW(TAG_MOUSE, "启用高分辨率滚轮失败: %s", esp_err_to_name(ret));
+  }
+}
 
 // LED控制
 static led_strip_handle_t led_strip = NULL;
@@ -218,6 +531,53 @@ esp_err_t mouse_accumulator_send_ble_report(const uint8_t *report, uint8_t lengt
                              length, (uint8_t *)report);
 }
 
+/**
+ * @brief 通过BLE发送键盘报告(供keyboard_queue模块调用)
+ */
+esp_err_t keyboard_queue_send_ble_report(const uint8_t *report, uint8_t length)
+{
+  return hid_dev_send_report(hidd_le_env.gatt_if, ble_hid_conn_id,
+                             HID_RPT_ID_KEY_IN, HID_REPORT_TYPE_INPUT,
+                             length, (uint8_t *)report);
+}
+
+/**
+ * @brief 通过BLE发送NKRO位图键盘报告(供nkro_keyboard模块调用)
+ */
+esp_err_t nkro_keyboard_send_ble_report(const uint8_t *report, uint8_t length)
+{
+  return hid_dev_send_report(hidd_le_env.gatt_if, ble_hid_conn_id,
+                             HID_RPT_ID_NKRO_IN, HID_REPORT_TYPE_INPUT,
+                             length, (uint8_t *)report);
+}
+
+/**
+ * @brief 通过BLE发送消费类报告(供consumer_pipeline模块调用)
+ */
+esp_err_t consumer_pipeline_send_ble_report(const uint8_t *report, uint8_t length)
+{
+  return hid_dev_send_report(hidd_le_env.gatt_if, ble_hid_conn_id,
+                             HID_RPT_ID_CC_IN, HID_REPORT_TYPE_INPUT,
+                             length, (uint8_t *)report);
+}
+
+/**
+ * @brief 通过BLE发送手柄报告(供gamepad_resampler模块调用)
+ */
+esp_err_t gamepad_resampler_send_ble_report(const uint8_t *report, uint8_t length)
+{
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+  return hid_dev_send_report(hidd_le_env.gatt_if, ble_hid_conn_id,
+                             HID_RPT_ID_GAMEPAD_IN, HID_REPORT_TYPE_INPUT,
+                             length, (uint8_t *)report);
+#else
+  // 手柄报告未编入report map,无法发送
+  (void)report;
+  (void)length;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 /* =================================================================================================
    FUNCTION PROTOTYPES
    ================================================================================================= */
@@ -276,17 +636,10 @@ static void ble_hid_event_callback(esp_hidd_cb_event_t event, esp_hidd_cb_param_
     ble_hid_conn_id = param->connect.conn_id;
     ESP_LOGI(TAG_BLE, "BLE HID连接ID已设置: conn_id=%d", ble_hid_conn_id);
 
-    // 更新BLE连接参数以提高回报率
-    // min_interval = 0x0006 (7.5ms), max_interval = 0x0006 (7.5ms), latency = 0, timeout = 500 (625ms)
-    // 这些参数请求更短的连接间隔以获得更高的回报率
-    esp_ble_conn_update_params_t conn_params = {0};
-    memcpy(conn_params.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
-    conn_params.min_int = 0x0006; // 7.5ms (最小连接间隔)
-    conn_params.max_int = 0x0006; // 7.5ms (最大连接间隔，与min相同以获得固定间隔)
-    conn_params.latency = 0;      // 无延迟
-    conn_params.timeout = 0x0320; // 800 * 1.25ms = 1000ms 超时
-    esp_ble_gap_update_conn_params(&conn_params);
-    ESP_LOGI(TAG_BLE, "BLE连接参数已更新: interval=7.5ms, latency=0");
+    // 交给协商引擎主动请求7.5ms/latency 0,
+    // 被拒绝时由引擎沿fallback阶梯重试,空闲时自动放宽省电
+    conn_params_on_connect(param->connect.remote_bda);
+    ble_reconnect_on_connected();
     break;
   }
   case ESP_HIDD_EVENT_BLE_DISCONNECT:
@@ -295,10 +648,16 @@ static void ble_hid_event_callback(esp_hidd_cb_event_t event, esp_hidd_cb_param_
     ble_hid_conn_id = 0; // 重置连接ID
     ESP_LOGI(TAG_BLE, "ESP_HID_EVENT_BLE_DISCONNECT");
 
-    // 清理鼠标累加器（避免断线重连后发送旧数据）
+    // 清理鼠标累加器和键盘队列（避免断线重连后发送旧数据）
     mouse_accumulator_clear();
-
-    esp_ble_gap_start_advertising(&ble_hid_adv_params);
+    keyboard_queue_clear();
+    nkro_keyboard_clear();
+    gamepad_resampler_clear();
+    consumer_pipeline_clear();
+    conn_params_on_disconnect();
+
+    // 有绑定主机时优先定向广播快速重连,超时自动回退无定向
+    ble_reconnect_start_advertising();
     update_led_color();
     break;
   }
@@ -330,34 +689,20 @@ static void ble_hid_event_callback(esp_hidd_cb_event_t event, esp_hidd_cb_param_
              caps_lock ? "ON" : "OFF",
              scroll_lock ? "ON" : "OFF");
 
-    // 快速转发LED报告到USB键盘（如果已连接）
-    // 注意：hid_class_request_set_report可能阻塞，但这是必要的操作
-    // 如果频繁出现问题，可以考虑使用队列异步处理
-    if (usb_hid_devices.keyboard_handle)
+    // 异步转发: BLE回调只暂存最新LED状态并唤醒事件循环,
+    // USB控制传输由app_main任务执行,不再阻塞BLE栈的事件任务
+    // (单槽去重: 转发完成前的中间状态被最新状态取代,只发最终状态)
+    uint32_t prev = atomic_exchange(&s_pending_led_state, LED_PENDING_FLAG | led_state);
+    if ((prev & LED_PENDING_FLAG) == 0 && app_event_queue != NULL)
     {
-      // 复制数据到本地缓冲区（避免使用param->led_write.data，因为它可能在回调返回后失效）
-      uint8_t led_data = param->led_write.data[0];
-
-      // 使用Report ID 0发送LED报告（对于Boot Protocol兼容的键盘）
-      // 注意：大多数USB键盘的LED Output Report不使用Report ID
-      esp_err_t ret = hid_class_request_set_report(usb_hid_devices.keyboard_handle, HID_REPORT_TYPE_OUTPUT, 0, &led_data, 1);
-      if (ret != ESP_OK)
+      const app_event_queue_t led_evt = {
+          .event_group = APP_EVENT_LED_FORWARD};
+      if (xQueueSend(app_event_queue, &led_evt, 0) != pdTRUE)
       {
-        ESP_LOGW(TAG_BLE, "LED转发失败: %s", esp_err_to_name(ret));
-      }
-      else
-      {
-        ESP_LOGI(TAG_BLE, "LED转发成功: 0x%02X -> USB键盘 (Num:%s Caps:%s Scroll:%s)",
-                 led_data,
-                 (led_data & 0x01) ? "ON" : "OFF",
-                 (led_data & 0x02) ? "ON" : "OFF",
-                 (led_data & 0x04) ? "ON" : "OFF");
+        // 队列满: 状态已暂存,事件循环的超时节拍会兜底下发
+        ESP_LOGD(TAG_BLE, "LED唤醒事件入队失败,等待超时节拍下发");
       }
     }
-    else
-    {
-      ESP_LOGW(TAG_BLE, "USB键盘未连接，无法转发LED报告");
-    }
     break;
   }
   default:
@@ -366,12 +711,58 @@ static void ble_hid_event_callback(esp_hidd_cb_event_t event, esp_hidd_cb_param_
   return;
 }
 
+/**
+ * @brief 加密完成后发起链路层协商: 2M PHY + 数据长度扩展
+ *
+ * 6字节的鼠标notify在1M PHY/27字节LL载荷下空口时间最长;
+ * 协商到2M PHY每包空口时间减半,连接事件里留给重传和
+ * USB共存的余量更大。主机拒绝时保持现状,结果在GAP事件里记录
+ */
+static void negotiate_link_layer(esp_bd_addr_t bd_addr)
+{
+  esp_err_t ret = esp_ble_gap_set_preferred_phy(bd_addr, 0,
+                                                ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                                ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                                ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+  if (ret != ESP_OK)
+  {
+    // 请求发不出去只是少了优化,不影响已建立的连接
+    ESP_LOGW(TAG_BLE, "2M PHY请求发送失败(%s),保持1M", esp_err_to_name(ret));
+  }
+
+  ret = esp_ble_gap_set_pkt_data_len(bd_addr, 251);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG_BLE, "数据长度扩展请求发送失败(%s),保持默认27字节", esp_err_to_name(ret));
+  }
+}
+
+// PHY编号转可读名(esp_ble_gap_phy_t: 1=1M, 2=2M, 3=Coded)
+static const char *phy_name(uint8_t phy)
+{
+  switch (phy)
+  {
+  case ESP_BLE_GAP_PHY_1M:
+    return "1M";
+  case ESP_BLE_GAP_PHY_2M:
+    return "2M";
+  case ESP_BLE_GAP_PHY_CODED:
+    return "Coded";
+  default:
+    return "?";
+  }
+}
+
 static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param)
 {
   switch (event)
   {
   case ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT:
-    esp_ble_gap_start_advertising(&ble_hid_adv_params);
+    ble_reconnect_start_advertising();
+    break;
+  case ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT:
+    // 定向广播超时停止后由重连引擎接着拉起无定向广播
+    ble_reconnect_on_adv_stopped();
     break;
   case ESP_GAP_BLE_SEC_REQ_EVT:
     for (int i = 0; i < ESP_BD_ADDR_LEN; i++)
@@ -395,12 +786,48 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
     }
     else
     {
+      // 配对成功的主机记入绑定表,下次断开直接定向广播重连
+      ble_reconnect_on_auth_complete(param->ble_security.auth_cmpl.bd_addr,
+                                     param->ble_security.auth_cmpl.addr_type);
       update_led_color();
+      // 加密就绪后协商链路层参数(2M PHY + DLE)
+      negotiate_link_layer(bd_addr);
+    }
+    break;
+  case ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT:
+    // PHY协商结果: 主机拒绝2M时status非0或授予值仍为1M,保持现状即可
+    if (param->phy_update.status == ESP_BT_STATUS_SUCCESS)
+    {
+      ESP_LOGI(TAG_BLE, "PHY更新完成: TX=%s, RX=%s",
+               phy_name(param->phy_update.tx_phy), phy_name(param->phy_update.rx_phy));
+    }
+    else
+    {
+      ESP_LOGW(TAG_BLE, "PHY更新被拒绝(status=0x%02x),保持当前PHY", param->phy_update.status);
+    }
+    break;
+  case ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT:
+    // DLE协商结果: 双方取各自支持的最小值,旧主机上仍是27字节
+    if (param->pkt_data_length_cmpl.status == ESP_BT_STATUS_SUCCESS)
+    {
+      ESP_LOGI(TAG_BLE, "数据长度扩展完成: TX=%u字节, RX=%u字节",
+               (unsigned int)param->pkt_data_length_cmpl.params.tx_len,
+               (unsigned int)param->pkt_data_length_cmpl.params.rx_len);
+    }
+    else
+    {
+      ESP_LOGW(TAG_BLE, "数据长度扩展被拒绝(status=0x%02x),保持默认载荷",
+               param->pkt_data_length_cmpl.status);
     }
     break;
   case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT:
     // BLE连接参数更新完成事件
-    // 根据实际协商的连接间隔更新鼠标发送间隔
+    // 先交给协商引擎校验授予值(不满足时引擎会沿阶梯重试),
+    // 再根据实际协商的连接间隔更新鼠标发送间隔
+    conn_params_on_update(param->update_conn_params.status == ESP_BT_STATUS_SUCCESS,
+                          param->update_conn_params.conn_int,
+                          param->update_conn_params.latency,
+                          param->update_conn_params.timeout);
     if (param->update_conn_params.status == ESP_BT_STATUS_SUCCESS)
     {
       uint16_t conn_int = param->update_conn_params.conn_int;
@@ -445,41 +872,6 @@ void printBinary(uint8_t value)
   }
 }
 
-// Helper: extract unsigned bits (little-endian bit order) from a byte buffer
-static uint32_t get_bits_u32(const uint8_t *data, int data_len, uint32_t bit_offset, uint32_t bit_size)
-{
-  if (bit_size == 0 || bit_size > 32)
-    return 0;
-  uint32_t value = 0;
-  for (uint32_t i = 0; i < bit_size; i++)
-  {
-    uint32_t bit_index = bit_offset + i;
-    uint32_t byte_index = bit_index / 8;
-    uint32_t bit_in_byte = bit_index % 8;
-    if ((int)byte_index >= data_len)
-      break;
-    uint8_t bit = (data[byte_index] >> bit_in_byte) & 0x1;
-    value |= (bit << i);
-  }
-  return value;
-}
-
-// Helper: extract signed bits and sign-extend to 32-bit
-static int32_t get_bits_s32(const uint8_t *data, int data_len, uint32_t bit_offset, uint32_t bit_size)
-{
-  uint32_t u = get_bits_u32(data, data_len, bit_offset, bit_size);
-  if (bit_size == 0)
-    return 0;
-  uint32_t sign_bit = 1u << (bit_size - 1);
-  if (u & sign_bit)
-  {
-    // sign extend
-    uint32_t mask = (~0u) << bit_size;
-    return (int32_t)(u | mask);
-  }
-  return (int32_t)u;
-}
-
 /**
  * @brief USB HID Host Keyboard Interface report callback handler
  *
@@ -487,35 +879,53 @@ static int32_t get_bits_s32(const uint8_t *data, int data_len, uint32_t bit_offs
  * @param[in] data    Pointer to input report data buffer
  * @param[in] length  Length of input report data buffer
  */
-static void hid_host_keyboard_report_callback(hid_host_device_handle_t hid_device_handle, uint8_t *data, int length)
+static void HOT_PATH_IRAM_ATTR hid_host_keyboard_report_callback(hid_host_device_handle_t hid_device_handle, uint8_t *data, int length)
 {
   // 检查BLE连接状态（sec_conn表示安全连接已建立，conn_id=0也是有效的连接ID）
   if (!sec_conn)
   {
-    ESP_LOGW(TAG_KEYBOARD, "BLE未连接，跳过键盘报告发送 (sec_conn=%d, conn_id=%d)", sec_conn, ble_hid_conn_id);
+    DLOGW2(TAG_KEYBOARD, "BLE未连接，跳过键盘报告发送 (sec_conn=%d, conn_id=%d)", sec_conn, ble_hid_conn_id);
     return;
   }
 
   // 检查数据长度
   if (length < sizeof(hid_keyboard_input_report_boot_t))
   {
-    ESP_LOGW(TAG_KEYBOARD, "键盘报告长度不足: %d < %zu", length, sizeof(hid_keyboard_input_report_boot_t));
+    DLOGW2(TAG_KEYBOARD, "键盘报告长度不足: %d < %d", length, (int)sizeof(hid_keyboard_input_report_boot_t));
     return;
   }
 
-  // 发送键盘报告到BLE
-  ESP_LOGI(TAG_KEYBOARD, "准备发送键盘报告: report_id=%d, length=%d, data[0]=0x%02X, conn_id=%d",
-           HID_RPT_ID_KEY_IN, HID_KEYBOARD_IN_RPT_LEN, data[0], ble_hid_conn_id);
-  esp_err_t ret = hid_dev_send_report(hidd_le_env.gatt_if, ble_hid_conn_id, HID_RPT_ID_KEY_IN, HID_REPORT_TYPE_INPUT, HID_KEYBOARD_IN_RPT_LEN, data);
-  if (ret != ESP_OK)
+  // 主机切换热键: Ctrl+Alt+F1..F4 切换到对应绑定槽位
+  // 热键报告本机消费,不转发给当前主机(避免目标主机收到半截组合键)
+  if ((data[0] & 0x05) == 0x05)
   {
-    ESP_LOGW(TAG_KEYBOARD, "发送键盘报告到BLE失败: %s (conn_id=%d, report_id=%d)",
-             esp_err_to_name(ret), ble_hid_conn_id, HID_RPT_ID_KEY_IN);
+    for (int i = 2; i < length && i < 8; i++)
+    {
+      if (data[i] >= 0x3A && data[i] <= 0x3D) // F1..F4
+      {
+        ble_reconnect_switch_to_slot(data[i] - 0x3A);
+        return;
+      }
+    }
+  }
+
+  // 键盘报告入队,由ble_tx任务异步发送
+  // USB回调不再直接走BLE栈,BLE拥塞时不会反压USB接收路径
+  ESP_LOGD(TAG_KEYBOARD, "键盘报告入队: data[0]=0x%02X, conn_id=%d", data[0], ble_hid_conn_id);
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+  // NKRO模式: 翻译成位图报告走Report ID 6,没有6键滚转限制
+  // BLE主机处于Boot Protocol模式时退回标准6KRO报告(Boot主机不解析Report Map)
+  if (hidProtocolMode == HID_PROTOCOL_MODE_REPORT)
+  {
+    nkro_keyboard_push(data, length);
   }
   else
   {
-    ESP_LOGI(TAG_KEYBOARD, "✓ 键盘报告已发送成功");
+    keyboard_queue_push(data);
   }
+#else
+  keyboard_queue_push(data);
+#endif
 
   hid_keyboard_input_report_boot_t *kb_report = (hid_keyboard_input_report_boot_t *)data;
 
@@ -550,35 +960,50 @@ static void hid_host_keyboard_report_callback(hid_host_device_handle_t hid_devic
  * @param[in] data    Pointer to input report data buffer
  * @param[in] length  Length of input report data buffer
  */
-static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_handle, uint8_t *data, int length)
+static void HOT_PATH_IRAM_ATTR hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_handle, uint8_t *data, int length)
 {
   // USB Boot Protocol 鼠标报告格式：按钮(1字节) + X位移(1字节) + Y位移(1字节) = 3字节
   // USB Report Protocol 鼠标报告格式：长度可变，可能包含 Report ID
   //   常见格式1：按钮(1) + X(1) + Y(1) + 滚轮(1) = 4字节
   //   常见格式2：Report ID(1) + 按钮(1) + X(1) + Y(1) + 滚轮(1) + 其他(3) = 8字节（macOS常见）
   // BLE鼠标报告格式（基于 report map，兼容 8bit 和 16bit）：
-  //   按钮(1字节: 5位按钮+3位padding) + X(16位,2字节) + Y(16位,2字节) + Wheel(8位,1字节) = 6字节
+  //   按钮(1字节: 5位按钮+3位padding) + X(16位,2字节) + Y(16位,2字节) + Wheel(8位,1字节) + AC Pan(8位,1字节) = 7字节
 
   if (length < 3)
   {
-    ESP_LOGW(TAG_MOUSE, "Mouse report too short: %d bytes (minimum 3)", length);
+    DLOGW1(TAG_MOUSE, "Mouse report too short: %d bytes (minimum 3)", length);
     return;
   }
 
   uint8_t buttons;
   int16_t x, y; // 改为16位以支持高精度
   int8_t wheel = 0;
+  int8_t pan = 0; // 水平滚轮(AC Pan),无则保持0
   static uint8_t last_buttons = 0;
   buttons = last_buttons; // default to last known buttons state
 
   // 声明变量供后续打包使用
   uint32_t buttons_u = 0;                 // buttons的完整值（可能超过8位）
   hid_report_layout_t *use_layout = NULL; // 用于判断是否从use_layout路径获取数据
+  hid_report_plan_t *use_plan = NULL;     // 与use_layout对应的预编译提取计划
 
   // 调试日志已移除以提高鼠标回报率性能
 
-  // 根据报告长度自动判断协议类型和格式
-  if (length == sizeof(hid_mouse_input_report_boot_t))
+  // O(1)分发表(枚举时构建): report_id直接索引出layout/plan,
+  // 不做长度启发式、不做缓存验证、不做线性查找
+  mouse_layout_table_t *tbl = layout_table_find(hid_device_handle);
+  if (tbl != NULL && tbl->dispatch_built && tbl->layout_count > 0)
+  {
+    int8_t idx = tbl->has_report_ids ? tbl->dispatch_layout[data[0]] : tbl->layout_no_id;
+    if (idx >= 0 && (uint32_t)length * 8 >= tbl->layouts[idx].report_size_bits)
+    {
+      use_layout = &tbl->layouts[idx];
+      use_plan = &tbl->plans[idx];
+    }
+  }
+
+  // 分发表未命中(表满/descriptor解析失败/异常短包): 按原有长度启发式回退
+  if (!use_layout && length == sizeof(hid_mouse_input_report_boot_t))
   {
     // Boot Protocol 格式：3字节（按钮+X+Y）
     hid_mouse_input_report_boot_t *mouse_report = (hid_mouse_input_report_boot_t *)data;
@@ -589,27 +1014,29 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
     wheel = 0; // Boot Protocol 不支持滚轮
     ESP_LOGD(TAG_MOUSE, "Parsed as Boot Protocol (3 bytes)");
   }
-  else if (length >= 5) // 支持基于 Zephyr report map 的5字节格式，以及其他更长的格式
+  else if (use_layout || length >= 5) // 支持基于 Zephyr report map 的5字节格式，以及其他更长的格式
   {
     // First, if we have parsed layouts, try to find one matching this packet (by Report ID or size)
-    // use_layout已在函数开始处声明
-    if (g_mouse_layout_count > 0)
+    // use_layout已在函数开始处声明(分发表命中时已定位,跳过查找)
+    if (!use_layout && tbl != NULL && tbl->layout_count > 0)
     {
       uint8_t pid = data[0];
 
-      // 尝试使用缓存的layout（性能优化）
-      if (g_cached_layout != NULL && g_cached_report_id == pid)
+      // 尝试使用本设备缓存的layout（性能优化）
+      if (tbl->cached_layout != NULL && tbl->cached_report_id == pid)
       {
         // 验证缓存的layout仍然有效
-        if ((uint32_t)length * 8 >= g_cached_layout->report_size_bits)
+        if ((uint32_t)length * 8 >= tbl->cached_layout->report_size_bits)
         {
-          use_layout = g_cached_layout;
+          use_layout = tbl->cached_layout;
+          use_plan = tbl->cached_plan;
         }
         else
         {
           // 缓存失效，清除缓存
-          g_cached_layout = NULL;
-          g_cached_report_id = 0xFF;
+          tbl->cached_layout = NULL;
+          tbl->cached_plan = NULL;
+          tbl->cached_report_id = 0xFF;
         }
       }
 
@@ -617,17 +1044,19 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
       if (!use_layout)
       {
         // try exact report_id match first
-        for (int i = 0; i < g_mouse_layout_count; i++)
+        for (int i = 0; i < tbl->layout_count; i++)
         {
-          if (g_mouse_layouts[i].report_id != 0 && pid == g_mouse_layouts[i].report_id)
+          if (tbl->layouts[i].report_id != 0 && pid == tbl->layouts[i].report_id)
           {
             // ensure packet has enough bits
-            if ((uint32_t)length * 8 >= g_mouse_layouts[i].report_size_bits)
+            if ((uint32_t)length * 8 >= tbl->layouts[i].report_size_bits)
             {
-              use_layout = &g_mouse_layouts[i];
+              use_layout = &tbl->layouts[i];
+              use_plan = &tbl->plans[i];
               // 缓存找到的layout
-              g_cached_layout = use_layout;
-              g_cached_report_id = pid;
+              tbl->cached_layout = use_layout;
+              tbl->cached_plan = use_plan;
+              tbl->cached_report_id = pid;
               break;
             }
           }
@@ -635,14 +1064,16 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
         // try report_id == 0 layouts (no report id)
         if (!use_layout)
         {
-          for (int i = 0; i < g_mouse_layout_count; i++)
+          for (int i = 0; i < tbl->layout_count; i++)
           {
-            if (g_mouse_layouts[i].report_id == 0 && (uint32_t)length * 8 >= g_mouse_layouts[i].report_size_bits)
+            if (tbl->layouts[i].report_id == 0 && (uint32_t)length * 8 >= tbl->layouts[i].report_size_bits)
             {
-              use_layout = &g_mouse_layouts[i];
+              use_layout = &tbl->layouts[i];
+              use_plan = &tbl->plans[i];
               // 缓存找到的layout
-              g_cached_layout = use_layout;
-              g_cached_report_id = 0; // report_id为0的情况
+              tbl->cached_layout = use_layout;
+              tbl->cached_plan = use_plan;
+              tbl->cached_report_id = 0; // report_id为0的情况
               break;
             }
           }
@@ -653,63 +1084,51 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
     if (use_layout)
     {
       // ========================================================================
-      // Bit Offset 调整说明：
+      // 使用预编译提取计划（hid_report_plan_compile在枚举时生成）
       // ========================================================================
-      // HID Report Parser 返回的 bit_offset 是相对于报告数据开始计算的，
-      // 不包括 report_id。因此：
-      // - 如果 report_id 存在（非 0）：需要调整 bit_offset，跳过 report_id
-      // - 如果 report_id 不存在（0）：不需要调整，bit_offset 从数据开始计算
-      //
-      // 根据 HID 规范，Report ID 通常是 1 字节（8 位）
-      // 参考：hid_report_parser.c 中，当遇到新的 report_id 时，
-      //       current_bit_offset 会被重置为 0（从报告数据开始）
+      // plan中的字节偏移/位移/掩码/符号扩展常量已在枚举阶段算好，
+      // report_id存在时的偏移调整（跳过1字节）也已包含在plan内。
+      // 字节对齐的8/16位字段走专用快速路径，其余走通用移位+掩码路径。
       // ========================================================================
-      uint32_t bit_offset_adjust = 0;
-      if (use_layout->report_id != 0)
+      if (length < use_plan->min_length)
       {
-        // Report ID 存在，需要跳过 report_id（1 字节 = 8 位）
-        bit_offset_adjust = HID_REPORT_ID_SIZE_BITS;
-
-        // 验证数据长度是否足够（至少包含 report_id + 最小数据）
-        if (length < 2) // 至少需要 report_id(1) + 最小数据(1)
-        {
-          ESP_LOGW(TAG_MOUSE, "Report data too short: length=%d, expected at least 2 bytes (report_id + data)", length);
-          return;
-        }
+        DLOGW2(TAG_MOUSE, "Report data too short: length=%d, expected at least %d bytes", length, use_plan->min_length);
+        return;
       }
-      // else: report_id == 0，不需要调整，bit_offset 从数据开始计算
 
       // ========================================================================
-      // 调试：打印解析出的字段偏移量（仅打印一次）
+      // 调试：打印提取计划（仅打印一次）
       // ========================================================================
       static bool offset_printed = false;
       if (!offset_printed)
       {
-        ESP_LOGI(TAG_MOUSE, "========== Parsed Mouse Layout Offsets ==========");
-        ESP_LOGI(TAG_MOUSE, "Report ID: %u", use_layout->report_id);
-        ESP_LOGI(TAG_MOUSE, "Bit offset adjust: %" PRIu32 " bits", bit_offset_adjust);
-        ESP_LOGI(TAG_MOUSE, "Buttons: offset=%" PRIu32 " bits, count=%" PRIu32,
-                 use_layout->buttons_bit_offset + bit_offset_adjust, use_layout->buttons_count);
-        ESP_LOGI(TAG_MOUSE, "X: offset=%" PRIu32 " bits, size=%" PRIu32 " bits",
-                 use_layout->x_bit_offset + bit_offset_adjust, use_layout->x_size);
-        ESP_LOGI(TAG_MOUSE, "Y: offset=%" PRIu32 " bits, size=%" PRIu32 " bits",
-                 use_layout->y_bit_offset + bit_offset_adjust, use_layout->y_size);
-        ESP_LOGI(TAG_MOUSE, "Wheel: offset=%" PRIu32 " bits, size=%" PRIu32 " bits",
-                 use_layout->wheel_bit_offset + bit_offset_adjust, use_layout->wheel_size);
-        ESP_LOGI(TAG_MOUSE, "================================================");
+        ESP_LOGI(TAG_MOUSE, "========== Compiled Mouse Extraction Plan ==========");
+        ESP_LOGI(TAG_MOUSE, "Report ID: %u, min_length: %u", use_plan->report_id, use_plan->min_length);
+        ESP_LOGI(TAG_MOUSE, "Buttons: kind=%u byte=%u shift=%u bits=%u",
+                 use_plan->buttons.kind, use_plan->buttons.byte_offset, use_plan->buttons.shift, use_plan->buttons.bit_size);
+        ESP_LOGI(TAG_MOUSE, "X: kind=%u byte=%u shift=%u bits=%u",
+                 use_plan->x.kind, use_plan->x.byte_offset, use_plan->x.shift, use_plan->x.bit_size);
+        ESP_LOGI(TAG_MOUSE, "Y: kind=%u byte=%u shift=%u bits=%u",
+                 use_plan->y.kind, use_plan->y.byte_offset, use_plan->y.shift, use_plan->y.bit_size);
+        ESP_LOGI(TAG_MOUSE, "Wheel: kind=%u byte=%u shift=%u bits=%u",
+                 use_plan->wheel.kind, use_plan->wheel.byte_offset, use_plan->wheel.shift, use_plan->wheel.bit_size);
+        ESP_LOGI(TAG_MOUSE, "====================================================");
         offset_printed = true;
       }
 
       // ========================================================================
-      // Buttons 数据提取（参考 asterics 仓库逻辑）
+      // Buttons 数据提取
       // ========================================================================
       // 直接提取完整的 buttons 值，不进行中间转换
       // 在打包时直接使用 buttons_u & 0x1F 获取低5位（支持侧键）
       // ========================================================================
-      buttons_u = get_bits_u32(data, length, use_layout->buttons_bit_offset + bit_offset_adjust, use_layout->buttons_count);
-      int32_t x_raw = use_layout->x_size ? get_bits_s32(data, length, use_layout->x_bit_offset + bit_offset_adjust, use_layout->x_size) : 0;
-      int32_t y_raw = use_layout->y_size ? get_bits_s32(data, length, use_layout->y_bit_offset + bit_offset_adjust, use_layout->y_size) : 0;
-      int32_t wheel_raw = use_layout->wheel_size ? get_bits_s32(data, length, use_layout->wheel_bit_offset + bit_offset_adjust, use_layout->wheel_size) : 0;
+      PERF_PROBE_BEGIN();
+      buttons_u = hid_field_extract_u32(&use_plan->buttons, data, length);
+      int32_t x_raw = hid_field_extract_s32(&use_plan->x, data, length);
+      int32_t y_raw = hid_field_extract_s32(&use_plan->y, data, length);
+      int32_t wheel_raw = hid_field_extract_s32(&use_plan->wheel, data, length);
+      int32_t pan_raw = hid_field_extract_s32(&use_plan->pan, data, length);
+      PERF_PROBE_END(PERF_STAGE_MOUSE_EXTRACT);
 
       // ========================================================================
       // X/Y/Wheel 数据转换（参考 asterics 仓库逻辑）
@@ -721,6 +1140,7 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
       x = use_layout->x_size ? (int16_t)x_raw : 0;
       y = use_layout->y_size ? (int16_t)y_raw : 0;
       wheel = use_layout->wheel_size ? (int8_t)wheel_raw : 0;
+      pan = use_layout->pan_size ? (int8_t)pan_raw : 0;
 
       // 调试日志已禁用以提高鼠标回报率性能
       // if (x_raw != 0 || y_raw != 0 || wheel_raw != 0)
@@ -729,8 +1149,6 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
       //            (int)x_raw, (int)x, (int)y_raw, (int)y, (int)wheel_raw, (int)wheel);
       // }
 
-      // 注意：pan（水平滚动）数据在 BLE 报告中不被使用，因此不提取
-      // 参考 asterics 仓库逻辑，不处理 pan 数据
     }
     else
     {
@@ -752,7 +1170,7 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
         }
         else
         {
-          ESP_LOGW(TAG_MOUSE, "Report with ID 0x%02X too short: length=%d, expected at least 5 bytes", data[0], length);
+          DLOGW2(TAG_MOUSE, "Report with ID 0x%02X too short: length=%d, expected at least 5 bytes", data[0], length);
           return;
         }
       }
@@ -768,7 +1186,7 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
         }
         else
         {
-          ESP_LOGW(TAG_MOUSE, "Report without ID too short: length=%d, expected at least 4 bytes", length);
+          DLOGW1(TAG_MOUSE, "Report without ID too short: length=%d, expected at least 4 bytes", length);
           return;
         }
       }
@@ -801,7 +1219,7 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
       }
       else
       {
-        ESP_LOGW(TAG_MOUSE, "Report Protocol with ID 0x%02X too short: length=%d, expected at least 4 bytes", data[0], length);
+        DLOGW2(TAG_MOUSE, "Report Protocol with ID 0x%02X too short: length=%d, expected at least 4 bytes", data[0], length);
         return;
       }
     }
@@ -825,7 +1243,7 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
       }
       else
       {
-        ESP_LOGW(TAG_MOUSE, "Report Protocol without ID too short: length=%d, expected at least 3 bytes", length);
+        DLOGW1(TAG_MOUSE, "Report Protocol without ID too short: length=%d, expected at least 3 bytes", length);
         return;
       }
     }
@@ -891,7 +1309,7 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
 #endif
 
   // 累加到全局累加器（线程安全）
-  mouse_accumulator_add(x, y, wheel, buttons_final);
+  mouse_accumulator_add(x, y, wheel, pan, buttons_final);
 
   // 保存按钮状态供下次比较
   last_buttons = buttons_final;
@@ -901,6 +1319,23 @@ static void hid_host_mouse_report_callback(hid_host_device_handle_t hid_device_h
   // 该函数由定时器按固定节拍调用，确保发送速率稳定
 }
 
+/**
+ * @brief USB HID Host Consumer Control report callback handler
+ *
+ * 分发表把Consumer Control collection(媒体键)的报告路由到这里,
+ * 独立report_id的媒体键不再落进generic处理被日志吃掉
+ *
+ * @param[in] data    Pointer to input report data buffer (含report_id)
+ * @param[in] length  Length of input report data buffer
+ * @param[in] has_report_id  报告首字节是否为report_id
+ */
+static void HOT_PATH_IRAM_ATTR hid_host_consumer_report_callback(const uint8_t *data, int length, bool has_report_id)
+{
+  // 经消费类管线转发: 按设备布局提取16位usage,状态变化入队,
+  // 同一发送窗口内的按下/释放由ble_tx任务背靠背notify
+  consumer_pipeline_push(data, length, has_report_id);
+}
+
 /**
  * @brief USB HID Host Generic Interface report callback handler
  *
@@ -926,6 +1361,111 @@ static void hid_host_generic_report_callback(const uint8_t *const data, const in
   putchar('\n');
 }
 
+/**
+ * @brief 解析并路由一条USB输入报告(report_worker任务上下文)
+ *
+ * 分发表路由+协议回退的全部逻辑都在这里;从接口回调拆出来之后
+ * HID Host驱动任务只负责收包递交,立即续排下一个中断IN传输
+ */
+void HOT_PATH_IRAM_ATTR usb_hid_report_process(hid_host_device_handle_t hid_device_handle,
+                                               uint8_t *data,
+                                               size_t length,
+                                               const hid_host_dev_params_t *dev_params)
+{
+  // O(1)分发表路由: 报告ID集合在枚举时已按Application Collection分类,
+  // 每个包一次数组访问路由到对应处理器;复合设备上挂在独立report_id
+  // 后面的媒体键由此转发到Consumer报告而不是落进generic日志
+  bool routed = false;
+  mouse_layout_table_t *route_tbl = layout_table_find(hid_device_handle);
+  if (route_tbl != NULL && route_tbl->dispatch_built && length > 0)
+  {
+    uint8_t route = route_tbl->has_report_ids ? route_tbl->dispatch_route[data[0]]
+                                              : route_tbl->route_no_id;
+    switch (route)
+    {
+    case HID_RID_CLASS_MOUSE:
+      // plan偏移已包含report_id字节,传完整数据包
+      hid_host_mouse_report_callback(hid_device_handle, data, length);
+      routed = true;
+      break;
+    case HID_RID_CLASS_KEYBOARD:
+      // 键盘处理器期望修饰键在首字节,报告带report_id时跳过它
+      if (route_tbl->has_report_ids)
+      {
+        hid_host_keyboard_report_callback(hid_device_handle, data + 1, (int)length - 1);
+      }
+      else
+      {
+        hid_host_keyboard_report_callback(hid_device_handle, data, length);
+      }
+      routed = true;
+      break;
+    case HID_RID_CLASS_CONSUMER:
+      hid_host_consumer_report_callback(data, length, route_tbl->has_report_ids);
+      routed = true;
+      break;
+    case HID_RID_CLASS_GAMEPAD:
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+      // 重采样后经Report ID 4转发(轴取最新值,按钮过渡逐个保留)
+      gamepad_resampler_push(data, length);
+#else
+      hid_host_generic_report_callback(data, length);
+#endif
+      routed = true;
+      break;
+    default:
+      // UNKNOWN: 交给下面的协议字段路由兜底
+      break;
+    }
+  }
+
+  // 分发表未构建(表满/descriptor不可用)时的回退:
+  // 根据协议类型和报告长度自动判断协议模式
+  // Boot Protocol 鼠标：3字节（按钮+X+Y）
+  // Boot Protocol 键盘：8字节（修饰键+保留+6个按键）
+  // Report Protocol：长度可变，通常>=4字节
+
+  if (routed)
+  {
+    // 已由分发表路由
+  }
+  else if (HID_PROTOCOL_KEYBOARD == dev_params->proto)
+  {
+    // 键盘：Boot Protocol 固定8字节，Report Protocol 可能不同长度
+#if defined(CONFIG_DEBUG_KEY_MOUSE_PRESS) && CONFIG_DEBUG_KEY_MOUSE_PRESS
+    if (HID_SUBCLASS_BOOT_INTERFACE == dev_params->sub_class && length == 8)
+    {
+      ESP_LOGI(TAG_KEYBOARD, "Keyboard Event (Boot Protocol, len=%d)", (int)length);
+    }
+    else
+    {
+      ESP_LOGI(TAG_KEYBOARD, "Keyboard Event (Report Protocol, len=%d)", (int)length);
+    }
+#endif
+    hid_host_keyboard_report_callback(hid_device_handle, data, length);
+  }
+  else if (HID_PROTOCOL_MOUSE == dev_params->proto)
+  {
+    // 鼠标：根据报告长度自动判断协议类型
+    // Boot Protocol: 3字节（按钮+X+Y）
+    // Report Protocol: 4字节或更多（可能包含滚轮、额外按钮等）
+    hid_host_mouse_report_callback(hid_device_handle, data, length);
+  }
+  else
+  {
+    // 其他协议类型
+    if (HID_SUBCLASS_BOOT_INTERFACE == dev_params->sub_class)
+    {
+      ESP_LOGI(TAG_GENERIC, "Generic Boot Interface Event (len=%d)", (int)length);
+    }
+    else
+    {
+      ESP_LOGI(TAG_GENERIC, "Generic Event (Report Protocol, len=%d)", (int)length);
+    }
+    hid_host_generic_report_callback(data, length);
+  }
+}
+
 /**
  * @brief USB HID Host interface callback
  *
@@ -937,7 +1477,7 @@ void usb_hid_host_interface_callback(hid_host_device_handle_t hid_device_handle,
                                      const hid_host_interface_event_t event,
                                      void *arg)
 {
-  uint8_t data[64] = {0};
+  uint8_t stack_buf[64] = {0};
   size_t data_length = 0;
   hid_host_dev_params_t dev_params;
 
@@ -957,14 +1497,13 @@ void usb_hid_host_interface_callback(hid_host_device_handle_t hid_device_handle,
     if (usb_hid_devices.keyboard_handle == hid_device_handle)
     {
       usb_hid_devices.keyboard_handle = NULL;
+      layout_table_release(hid_device_handle);
       ESP_LOGI(TAG_KEYBOARD, "键盘设备句柄已清除（接口断开，通过句柄匹配）");
     }
     if (usb_hid_devices.mouse_handle == hid_device_handle)
     {
       usb_hid_devices.mouse_handle = NULL;
-      g_cached_layout = NULL;
-      g_cached_report_id = 0xFF;
-      g_mouse_layout_count = 0;
+      layout_table_release(hid_device_handle);
       ESP_LOGI(TAG_MOUSE, "鼠标设备句柄已清除（接口断开，通过句柄匹配）");
     }
     // 尝试关闭设备（可能会失败，但这是正常的）
@@ -990,64 +1529,32 @@ void usb_hid_host_interface_callback(hid_host_device_handle_t hid_device_handle,
   switch (event)
   {
   case HID_HOST_INTERFACE_EVENT_INPUT_REPORT:
+  {
+    // 优先用池化缓冲: USB层只写一次,工作任务直接引用同一块内存,
+    // 不做memcpy;池耗尽(不应发生,计入统计)时退回栈缓冲,
+    // 递交时由工作环的内联拷贝槽接管
+    report_buf_t *rbuf = report_pool_acquire();
+    uint8_t *data = (rbuf != NULL) ? rbuf->data : stack_buf;
+
     ESP_ERROR_CHECK(hid_host_device_get_raw_input_report_data(hid_device_handle,
                                                               data,
-                                                              64,
+                                                              REPORT_POOL_BUF_SIZE,
                                                               &data_length));
-
-    // 根据协议类型和报告长度自动判断协议模式
-    // Boot Protocol 鼠标：3字节（按钮+X+Y）
-    // Boot Protocol 键盘：8字节（修饰键+保留+6个按键）
-    // Report Protocol：长度可变，通常>=4字节
-
-    if (HID_PROTOCOL_KEYBOARD == dev_params.proto)
+    if (rbuf != NULL)
     {
-      // 键盘：Boot Protocol 固定8字节，Report Protocol 可能不同长度
-#if defined(CONFIG_DEBUG_KEY_MOUSE_PRESS) && CONFIG_DEBUG_KEY_MOUSE_PRESS
-      if (HID_SUBCLASS_BOOT_INTERFACE == dev_params.sub_class && data_length == 8)
-      {
-        ESP_LOGI(TAG_KEYBOARD, "Keyboard Event (Boot Protocol, len=%d)", data_length);
-      }
-      else
-      {
-        ESP_LOGI(TAG_KEYBOARD, "Keyboard Event (Report Protocol, len=%d)", data_length);
-      }
-#endif
-      hid_host_keyboard_report_callback(hid_device_handle, data, data_length);
+      rbuf->length = (uint16_t)data_length;
     }
-    else if (HID_PROTOCOL_MOUSE == dev_params.proto)
-    {
-      // 鼠标：根据报告长度自动判断协议类型
-      // Boot Protocol: 3字节（按钮+X+Y）
-      // Report Protocol: 4字节或更多（可能包含滚轮、额外按钮等）
 
-      // 已禁用日志以提高性能
-      // bool is_boot_protocol = (HID_SUBCLASS_BOOT_INTERFACE == dev_params.sub_class && data_length == 3);
-      // if (is_boot_protocol)
-      // {
-      //   ESP_LOGD(TAG_MOUSE, "Mouse Event (Boot Protocol, len=%d)", data_length);
-      // }
-      // else
-      // {
-      //   ESP_LOGD(TAG_MOUSE, "Mouse Event (Report Protocol, len=%d)", data_length);
-      // }
-      hid_host_mouse_report_callback(hid_device_handle, data, data_length);
-    }
-    else
-    {
-      // 其他协议类型
-      if (HID_SUBCLASS_BOOT_INTERFACE == dev_params.sub_class)
-      {
-        ESP_LOGI(TAG_GENERIC, "Generic Boot Interface Event (len=%d)", data_length);
-      }
-      else
-      {
-        ESP_LOGI(TAG_GENERIC, "Generic Event (Report Protocol, len=%d)", data_length);
-      }
-      hid_host_generic_report_callback(data, data_length);
-    }
+    // 传输流水线: 本回调只收包递交,驱动任务立即续排下一个中断IN传输,
+    // 1000Hz轮询不再等待解析;布局查找/字段提取在report_worker任务里做。
+    // 递交失败(工作环满,病态积压)时丢弃本条——不退回同步解析,
+    // 保证下游各SPSC环的生产者唯一
+    report_worker_submit(hid_device_handle, rbuf, data, data_length, &dev_params);
 
+    // 本层引用释放;submit成功时工作任务持有的引用在处理完后才回池
+    report_pool_release(rbuf);
     break;
+  }
   case HID_HOST_INTERFACE_EVENT_DISCONNECTED:
     ESP_LOGI(TAG_USB, "=========================================");
     ESP_LOGI(TAG_USB, "USB HID接口已断开");
@@ -1063,6 +1570,8 @@ void usb_hid_host_interface_callback(hid_host_device_handle_t hid_device_handle,
       if (usb_hid_devices.keyboard_handle == hid_device_handle)
       {
         usb_hid_devices.keyboard_handle = NULL;
+        // 释放本设备的分发表
+        layout_table_release(hid_device_handle);
         ESP_LOGI(TAG_KEYBOARD, "键盘设备句柄已清除（接口断开）");
       }
     }
@@ -1071,10 +1580,8 @@ void usb_hid_host_interface_callback(hid_host_device_handle_t hid_device_handle,
       if (usb_hid_devices.mouse_handle == hid_device_handle)
       {
         usb_hid_devices.mouse_handle = NULL;
-        // 清除layout缓存
-        g_cached_layout = NULL;
-        g_cached_report_id = 0xFF;
-        g_mouse_layout_count = 0; // 清除所有layout
+        // 释放本设备的layout表
+        layout_table_release(hid_device_handle);
         ESP_LOGI(TAG_MOUSE, "鼠标设备句柄已清除（接口断开）");
       }
     }
@@ -1105,15 +1612,14 @@ void usb_hid_host_interface_callback(hid_host_device_handle_t hid_device_handle,
     {
       ESP_LOGW(TAG_KEYBOARD, "键盘设备传输错误，清除句柄（驱动层将自动恢复）");
       usb_hid_devices.keyboard_handle = NULL;
+      layout_table_release(hid_device_handle);
       update_led_color();
     }
     else if (dev_params.proto == HID_PROTOCOL_MOUSE && usb_hid_devices.mouse_handle == hid_device_handle)
     {
       ESP_LOGW(TAG_MOUSE, "鼠标设备传输错误，清除句柄（驱动层将自动恢复）");
       usb_hid_devices.mouse_handle = NULL;
-      g_cached_layout = NULL;
-      g_cached_report_id = 0xFF;
-      g_mouse_layout_count = 0;
+      layout_table_release(hid_device_handle);
       update_led_color();
     }
     // 注意：不尝试关闭或重启设备，因为接口状态可能异常
@@ -1195,15 +1701,33 @@ void usb_hid_host_device_event(hid_host_device_handle_t hid_device_handle,
     }
     // 非Boot Interface设备默认使用Report Protocol，无需设置
 
+    // 先查descriptor解析缓存: 同型号设备重新插入时跳过类型探测和layout解析,
+    // KVM频繁插拔场景下显著缩短首个报告的就绪时间
+    size_t cache_desc_len = 0;
+    const uint8_t *cache_desc = hid_host_get_report_descriptor(hid_device_handle, &cache_desc_len);
+    hid_desc_cache_entry_t cache_entry;
+    bool cache_hit = hid_desc_cache_lookup(cache_desc, cache_desc_len, &cache_entry);
+
     // 根据协议类型和Report Descriptor验证设备类型
     // 优先使用Report Descriptor检测，因为它更准确
     bool is_keyboard_from_desc = false;
     bool is_mouse_from_desc = false;
-    bool desc_check_success = hid_device_type_detect(hid_device_handle, &is_keyboard_from_desc, &is_mouse_from_desc);
+    bool desc_check_success;
+    if (cache_hit)
+    {
+      desc_check_success = cache_entry.desc_check_success;
+      is_keyboard_from_desc = cache_entry.is_keyboard;
+      is_mouse_from_desc = cache_entry.is_mouse;
+    }
+    else
+    {
+      desc_check_success = hid_device_type_detect(hid_device_handle, &is_keyboard_from_desc, &is_mouse_from_desc);
+    }
 
     // 决定设备类型：优先使用Descriptor检测结果，如果失败则回退到协议字段
     bool should_register_as_keyboard = false;
     bool should_register_as_mouse = false;
+    mouse_layout_table_t *mouse_tbl = NULL;
 
     if (desc_check_success)
     {
@@ -1250,6 +1774,16 @@ void usb_hid_host_device_event(hid_host_device_handle_t hid_device_handle,
       // 保存键盘设备句柄
       usb_hid_devices.keyboard_handle = hid_device_handle;
       ESP_LOGI(TAG_KEYBOARD, "键盘设备已注册");
+
+      // 键盘接口也构建分发表: 复合键盘挂在独立report_id后面的媒体键
+      // (Consumer collection)由此转发到BLE而不是落进generic日志
+      size_t kb_desc_len = 0;
+      const uint8_t *kb_desc = hid_host_get_report_descriptor(hid_device_handle, &kb_desc_len);
+      mouse_layout_table_t *kb_tbl = layout_table_alloc(hid_device_handle);
+      if (kb_tbl != NULL)
+      {
+        dispatch_table_build(kb_tbl, kb_desc, kb_desc_len);
+      }
     }
     else if (should_register_as_mouse)
     {
@@ -1262,7 +1796,26 @@ void usb_hid_host_device_event(hid_host_device_handle_t hid_device_handle,
       size_t report_desc_len = 0;
       const uint8_t *report_desc = hid_host_get_report_descriptor(hid_device_handle, &report_desc_len);
 
-      if (report_desc != NULL && report_desc_len > 0)
+      // 为该设备分配独立的layout表(多设备/Hub场景下互不干扰)
+      mouse_tbl = layout_table_alloc(hid_device_handle);
+      if (mouse_tbl == NULL)
+      {
+        ESP_LOGW(TAG_MOUSE, "layout表已满,该鼠标将使用默认/兼容解析逻辑");
+      }
+
+      if (mouse_tbl != NULL && cache_hit && cache_entry.layout_count > 0)
+      {
+        // 缓存命中: 直接恢复layout并编译提取计划,跳过整个descriptor解析流程
+        mouse_tbl->layout_count = cache_entry.layout_count;
+        memcpy(mouse_tbl->layouts, cache_entry.layouts,
+               (size_t)cache_entry.layout_count * sizeof(hid_report_layout_t));
+        for (int i = 0; i < mouse_tbl->layout_count; i++)
+        {
+          hid_report_plan_compile(&mouse_tbl->layouts[i], &mouse_tbl->plans[i]);
+        }
+        ESP_LOGI(TAG_MOUSE, "从NVS缓存恢复%d个鼠标layout,跳过descriptor解析", mouse_tbl->layout_count);
+      }
+      else if (mouse_tbl != NULL && report_desc != NULL && report_desc_len > 0)
       {
 
         if (report_desc_len % 16 != 0)
@@ -1272,14 +1825,20 @@ void usb_hid_host_device_event(hid_host_device_handle_t hid_device_handle,
         ESP_LOGI(TAG_MOUSE, "=========================================");
 
         // 解析并生成简单的report layout以便后续自动解析数据
-        g_mouse_layout_count = parse_hid_report_descriptor_layouts(report_desc, report_desc_len, g_mouse_layouts, MAX_MOUSE_LAYOUTS);
-        if (g_mouse_layout_count > 0)
+        mouse_tbl->layout_count = parse_hid_report_descriptor_layouts(report_desc, report_desc_len, mouse_tbl->layouts, MAX_MOUSE_LAYOUTS);
+        if (mouse_tbl->layout_count > 0)
         {
-          for (int i = 0; i < g_mouse_layout_count; i++)
+          // 为每个layout预编译提取计划（热路径只用plan，不再做通用位运算）
+          for (int i = 0; i < mouse_tbl->layout_count; i++)
+          {
+            hid_report_plan_compile(&mouse_tbl->layouts[i], &mouse_tbl->plans[i]);
+          }
+          for (int i = 0; i < mouse_tbl->layout_count; i++)
           {
-            hid_report_layout_t *l = &g_mouse_layouts[i];
-            ESP_LOGI(TAG_MOUSE, "Parsed mouse layout[%d]: report_id=%u, buttons=%u, buttons_bit_offset=%u, x: bit=%u size=%u, y: bit=%u size=%u, wheel: bit=%u size=%u, pan: bit=%u size=%u",
+            hid_report_layout_t *l = &mouse_tbl->layouts[i];
+            ESP_LOGI(TAG_MOUSE, "Parsed mouse layout[%d] (%s): report_id=%u, buttons=%u, buttons_bit_offset=%u, x: bit=%u size=%u, y: bit=%u size=%u, wheel: bit=%u size=%u, pan: bit=%u size=%u",
                      i,
+                     hid_report_class_name((hid_report_class_t)mouse_tbl->plans[i].report_class),
                      (unsigned int)l->report_id,
                      (unsigned int)l->buttons_count,
                      (unsigned int)l->buttons_bit_offset,
@@ -1322,24 +1881,52 @@ void usb_hid_host_device_event(hid_host_device_handle_t hid_device_handle,
           }
         }
       }
-      else
+      else if (mouse_tbl != NULL)
       {
         ESP_LOGW(TAG_MOUSE, "无法获取 HID Report Descriptor (长度: %zu)", report_desc_len);
       }
+
+      // 构建O(1)报告分发表(NVS缓存命中和完整解析两条路径都走这里)
+      dispatch_table_build(mouse_tbl, report_desc, report_desc_len);
+
+      // 高分辨率滚轮: descriptor有Resolution Multiplier就SET_FEATURE启用
+      // (与layout缓存无关,缓存命中路径同样生效)
+      mouse_enable_hires_scroll(hid_device_handle, report_desc, report_desc_len);
+    }
+
+    // 缓存未命中: 把本次的探测和解析结果写入NVS,下次插入同型号设备直接命中
+    if (!cache_hit && cache_desc != NULL && cache_desc_len > 0)
+    {
+      hid_desc_cache_entry_t new_entry = {
+          .desc_check_success = desc_check_success,
+          .is_keyboard = is_keyboard_from_desc,
+          .is_mouse = is_mouse_from_desc,
+          .layout_count = 0};
+      if (should_register_as_mouse && mouse_tbl != NULL && mouse_tbl->layout_count > 0)
+      {
+        new_entry.layout_count = (mouse_tbl->layout_count <= HID_DESC_CACHE_MAX_LAYOUTS)
+                                     ? (uint8_t)mouse_tbl->layout_count
+                                     : HID_DESC_CACHE_MAX_LAYOUTS;
+        memcpy(new_entry.layouts, mouse_tbl->layouts,
+               (size_t)new_entry.layout_count * sizeof(hid_report_layout_t));
+      }
+      hid_desc_cache_store(cache_desc, cache_desc_len, &new_entry);
     }
 
     int ret = hid_host_device_start(hid_device_handle);
     if (ret != ESP_OK)
     {
       ESP_LOGE(TAG_HID, "启动HID设备失败: %s", esp_err_to_name(ret));
-      // 如果启动失败，清理已注册的设备句柄
+      // 如果启动失败，清理已注册的设备句柄(连同分发表/layout表)
       if (should_register_as_keyboard)
       {
         usb_hid_devices.keyboard_handle = NULL;
+        layout_table_release(hid_device_handle);
       }
       else if (should_register_as_mouse)
       {
         usb_hid_devices.mouse_handle = NULL;
+        layout_table_release(hid_device_handle);
       }
       return;
     }
@@ -1444,6 +2031,45 @@ void usb_hid_host_device_callback(hid_host_device_handle_t hid_device_handle,
   }
 }
 
+/**
+ * @brief 把暂存的键盘LED状态下发到USB键盘(app_main事件循环上下文)
+ *
+ * 消费单槽去重的最新状态;下发期间到达的新状态会重新置位,
+ * 由下一次唤醒(或事件循环的超时节拍)再下发
+ */
+static void led_forward_service(void)
+{
+  uint32_t v = atomic_exchange(&s_pending_led_state, 0);
+  if ((v & LED_PENDING_FLAG) == 0)
+  {
+    return;
+  }
+
+  uint8_t led_data = (uint8_t)(v & 0xFF);
+  if (usb_hid_devices.keyboard_handle == NULL)
+  {
+    ESP_LOGW(TAG_USB, "USB键盘未连接，丢弃LED状态0x%02X", led_data);
+    return;
+  }
+
+  // 使用Report ID 0发送LED报告（对于Boot Protocol兼容的键盘）
+  // 注意：大多数USB键盘的LED Output Report不使用Report ID
+  esp_err_t ret = hid_class_request_set_report(usb_hid_devices.keyboard_handle,
+                                               HID_REPORT_TYPE_OUTPUT, 0, &led_data, 1);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG_USB, "LED转发失败: %s", esp_err_to_name(ret));
+  }
+  else
+  {
+    ESP_LOGI(TAG_USB, "LED转发成功: 0x%02X -> USB键盘 (Num:%s Caps:%s Scroll:%s)",
+             led_data,
+             (led_data & 0x01) ? "ON" : "OFF",
+             (led_data & 0x02) ? "ON" : "OFF",
+             (led_data & 0x04) ? "ON" : "OFF");
+  }
+}
+
 /* =================================================================================================
    LED控制辅助函数
    ================================================================================================= */
@@ -1463,18 +2089,27 @@ static void update_led_color(void)
   led_control_set_color(led_strip, usb_keyboard_connected, usb_mouse_connected, sec_conn);
 }
 
-void app_main(void)
+/* =================================================================================================
+   并行启动: BLE栈和USB Host各自在独立任务中起栈,汇合后再进入转发循环
+   ================================================================================================= */
+
+// 启动汇合事件组
+static EventGroupHandle_t s_startup_events = NULL;
+#define STARTUP_BLE_READY BIT0
+#define STARTUP_USB_READY BIT1
+
+/**
+ * @brief BLE栈初始化任务(固定到core 1,与core 0上的USB bring-up并行)
+ *
+ * controller/bluedroid的enable各需上百毫秒,串行在USB枚举前面
+ * 会直接拖慢上电到首次击键的时间;广播由REG_FINISH回调链自动拉起
+ */
+static void ble_init_task(void *arg)
 {
   esp_err_t ret;
 
-  // Initialize NVS.
-  ret = nvs_flash_init();
-  if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
-  {
-    ESP_ERROR_CHECK(nvs_flash_erase());
-    ret = nvs_flash_init();
-  }
-  ESP_ERROR_CHECK(ret);
+  // 先加载绑定主机表,广播拉起时才能决定走定向还是无定向
+  ESP_ERROR_CHECK(ble_reconnect_init(&ble_hid_adv_params));
 
   ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT));
 
@@ -1483,6 +2118,7 @@ void app_main(void)
   if (ret)
   {
     ESP_LOGE(TAG_BLE, "%s initialize controller failed", __func__);
+    vTaskDelete(NULL);
     return;
   }
 
@@ -1490,6 +2126,7 @@ void app_main(void)
   if (ret)
   {
     ESP_LOGE(TAG_BLE, "%s enable controller failed", __func__);
+    vTaskDelete(NULL);
     return;
   }
 
@@ -1497,6 +2134,7 @@ void app_main(void)
   if (ret)
   {
     ESP_LOGE(TAG_BLE, "%s init bluedroid failed", __func__);
+    vTaskDelete(NULL);
     return;
   }
 
@@ -1504,6 +2142,7 @@ void app_main(void)
   if (ret)
   {
     ESP_LOGE(TAG_BLE, "%s init bluedroid failed", __func__);
+    vTaskDelete(NULL);
     return;
   }
 
@@ -1532,7 +2171,45 @@ void app_main(void)
   esp_ble_gap_set_security_param(ESP_BLE_SM_SET_INIT_KEY, &init_key, sizeof(uint8_t));
   esp_ble_gap_set_security_param(ESP_BLE_SM_SET_RSP_KEY, &rsp_key, sizeof(uint8_t));
 
+  ESP_LOGI(TAG_BLE, "BLE栈初始化完成");
+  xEventGroupSetBits(s_startup_events, STARTUP_BLE_READY);
+  vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+  esp_err_t ret;
+  int64_t t_boot_us = esp_timer_get_time();
+
+  // Initialize NVS.
+  ret = nvs_flash_init();
+  if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+  {
+    ESP_ERROR_CHECK(nvs_flash_erase());
+    ret = nvs_flash_init();
+  }
+  ESP_ERROR_CHECK(ret);
+
+  // 初始化HID descriptor解析缓存(失败时自动降级为每次都解析)
+  hid_desc_cache_init();
+
+  // 初始化延迟日志(热路径诊断写无锁环,drain任务异步打印)
+  // 尽量早起,USB/BLE回调从一开始就能用DLOG宏
+  ESP_ERROR_CHECK(deferred_log_init());
+
+  // 创建启动汇合事件组,BLE栈在core 1上并行起栈,
+  // 本任务(core 0)继续USB Host bring-up,两边汇合后进入转发循环
+  s_startup_events = xEventGroupCreate();
+  assert(s_startup_events != NULL);
+
   BaseType_t task_created;
+  task_created = xTaskCreatePinnedToCore(ble_init_task,
+                                         "ble_init",
+                                         4096,
+                                         NULL,
+                                         5, NULL, 1);
+  assert(task_created == pdTRUE);
+
   ESP_LOGI(TAG_HID, "HID Host example");
 
   /*
@@ -1578,6 +2255,7 @@ void app_main(void)
     ESP_LOGE(TAG_HID, "Failed to create event queue");
     return;
   }
+  xEventGroupSetBits(s_startup_events, STARTUP_USB_READY);
 
   ESP_LOGI(TAG_HID, "等待USB HID设备连接...");
   ESP_LOGI(TAG_USB, "提示: 请插入USB键盘或鼠标设备");
@@ -1586,9 +2264,46 @@ void app_main(void)
   led_strip = led_control_init();
   update_led_color();
 
+  // 初始化报告缓冲池（USB回调零拷贝交接报告给下游阶段）
+  ESP_ERROR_CHECK(report_pool_init());
+
+  // 初始化报告解析工作任务（USB回调只收包递交,解析在此任务进行）
+  ESP_ERROR_CHECK(report_worker_init());
+
+  // 初始化键盘发送队列（消费端由ble_tx任务驱动,需在累加器之前就绪）
+  keyboard_queue_init();
+  nkro_keyboard_init();
+
+  // 初始化手柄重采样器(枚举到手柄descriptor时再配置提取计划)
+  gamepad_resampler_init();
+
+  // 初始化消费类转发管线(枚举到消费类descriptor时再配置布局)
+  consumer_pipeline_init();
+
   // 初始化鼠标累加器模块（创建BLE发送定时器）
   ESP_ERROR_CHECK(mouse_accumulator_init());
 
+  // 初始化连接参数协商引擎（连接后主动请求7.5ms,空闲时放宽省电）
+  ESP_ERROR_CHECK(conn_params_init());
+
+  // 初始化电源管理（空闲超时降频/可选light-sleep,输入即恢复全速）
+  ESP_ERROR_CHECK(power_mgmt_init());
+
+  // 启动片上输入基准(仅CONFIG_INPUT_BENCH启用时有动作)
+  ESP_ERROR_CHECK(input_bench_start());
+
+  // 汇合点: 等待BLE栈和USB Host都就绪后再开始转发
+  // (期间到达的HID Host事件留在队列里,汇合后按序处理)
+  EventBits_t ready = xEventGroupWaitBits(s_startup_events,
+                                          STARTUP_BLE_READY | STARTUP_USB_READY,
+                                          pdFALSE, pdTRUE, pdMS_TO_TICKS(10000));
+  if ((ready & (STARTUP_BLE_READY | STARTUP_USB_READY)) != (STARTUP_BLE_READY | STARTUP_USB_READY))
+  {
+    ESP_LOGW(TAG_HID, "启动汇合超时(bits=0x%x),仍继续运行", (unsigned int)ready);
+  }
+  ESP_LOGI(TAG_HID, "启动完成: BLE+USB均就绪,耗时%lldms",
+           (long long)((esp_timer_get_time() - t_boot_us) / 1000));
+
   TickType_t last_heartbeat = xTaskGetTickCount();
   const TickType_t heartbeat_interval = pdMS_TO_TICKS(5000); // 5秒心跳
 
@@ -1605,8 +2320,13 @@ void app_main(void)
                                   evt_queue.hid_host_device.event,
                                   evt_queue.hid_host_device.arg);
       }
+      // APP_EVENT_LED_FORWARD只用于提前唤醒本循环,下发统一在下面做
     }
 
+    // 键盘LED输出转发: 消费暂存的最新LED状态
+    // (唤醒事件入队失败时由这里的超时节拍兜底)
+    led_forward_service();
+
     // 心跳日志，确认程序在运行
     TickType_t now = xTaskGetTickCount();
     if ((now - last_heartbeat) >= heartbeat_interval)
@@ -1615,6 +2335,18 @@ void app_main(void)
                usb_hid_devices.keyboard_handle != NULL ? "已连接" : "未连接",
                usb_hid_devices.mouse_handle != NULL ? "已连接" : "未连接",
                sec_conn ? "已连接" : "未连接");
+      // 周期性输出端到端延迟统计(有样本时才打印)
+      mouse_accumulator_log_latency();
+      // 分段周期统计表(仅CONFIG_PERF_PROBES启用时有输出)
+      perf_probe_log_table();
+      // 解析工作任务积压情况(有丢弃或明显积压时才提醒)
+      uint32_t wk_dropped = 0, wk_max_pending = 0;
+      report_worker_get_stats(NULL, NULL, &wk_dropped, &wk_max_pending);
+      if (wk_dropped > 0 || wk_max_pending >= REPORT_WORKER_QUEUE_CAPACITY / 2)
+      {
+        ESP_LOGW(TAG_USB, "报告解析积压: 区间峰值%lu条, 累计丢弃%lu条",
+                 (unsigned long)wk_max_pending, (unsigned long)wk_dropped);
+      }
       last_heartbeat = now;
     }
   }
@@ -8,8 +8,10 @@
 #define HID_HOST_EXAMPLE_H__
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "usb/hid_host.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -32,6 +34,58 @@ extern "C"
    */
   esp_err_t mouse_accumulator_send_ble_report(const uint8_t *report, uint8_t length);
 
+  /**
+   * @brief 通过BLE发送键盘报告
+   *
+   * @param report 键盘报告数据（8字节）
+   * @param length 报告长度（应为8）
+   * @return ESP_OK 成功，其他值表示失败
+   */
+  esp_err_t keyboard_queue_send_ble_report(const uint8_t *report, uint8_t length);
+
+  /**
+   * @brief 通过BLE发送NKRO位图键盘报告
+   *
+   * @param report NKRO报告数据（16字节：修饰键+位图）
+   * @param length 报告长度（应为16）
+   * @return ESP_OK 成功，其他值表示失败
+   */
+  esp_err_t nkro_keyboard_send_ble_report(const uint8_t *report, uint8_t length);
+
+  /**
+   * @brief 通过BLE发送消费类报告(供consumer_pipeline模块调用)
+   *
+   * @param report 消费类报告数据(16位usage, LE)
+   * @param length 报告长度
+   * @return esp_err_t ESP_OK成功
+   */
+  esp_err_t consumer_pipeline_send_ble_report(const uint8_t *report, uint8_t length);
+
+  /**
+   * @brief 通过BLE发送手柄报告(供gamepad_resampler模块调用)
+   *
+   * @param report 手柄报告数据
+   * @param length 报告长度
+   * @return esp_err_t ESP_OK成功(未启用joystick时返回ESP_ERR_NOT_SUPPORTED)
+   */
+  esp_err_t gamepad_resampler_send_ble_report(const uint8_t *report, uint8_t length);
+
+  /**
+   * @brief 解析并路由一条USB输入报告(分发表路由+协议回退)
+   *
+   * 由report_worker任务调用(流水线路径),完成布局查找/字段提取/
+   * 入队等全部重活;HID Host驱动回调只负责收包递交
+   *
+   * @param hid_device_handle 报告来源设备句柄
+   * @param data 原始报告数据
+   * @param length 报告字节数
+   * @param dev_params 设备参数(回退路由需要proto/sub_class)
+   */
+  void usb_hid_report_process(hid_host_device_handle_t hid_device_handle,
+                              uint8_t *data,
+                              size_t length,
+                              const hid_host_dev_params_t *dev_params);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,8 @@
 #define ITEM_USAGE_PAGE 0x04
 #define ITEM_LOGICAL_MIN 0x14
 #define ITEM_LOGICAL_MAX 0x24
+#define ITEM_PHYSICAL_MIN 0x34
+#define ITEM_PHYSICAL_MAX 0x44
 #define ITEM_REPORT_SIZE 0x74
 #define ITEM_REPORT_ID 0x84
 #define ITEM_REPORT_COUNT 0x94
@@ -1020,3 +1022,1061 @@ int parse_hid_report_descriptor_layout(const void *descriptor, size_t descriptor
 
   return -1;
 }
+
+/* =================================================================================================
+   Resolution Multiplier feature扫描（高分辨率滚轮）
+   ================================================================================================= */
+
+// multiplier扫描用的精简global状态（含physical min/max,输入布局解析不需要它们）
+typedef struct
+{
+  uint8_t report_id;
+  uint16_t usage_page;
+  int32_t logical_min;
+  int32_t logical_max;
+  int32_t physical_min;
+  int32_t physical_max;
+  uint32_t report_size;
+  uint32_t report_count;
+} mult_globals_t;
+
+// 每个feature报告ID独立的位偏移计数
+#define MULT_MAX_FEATURE_REPORTS 8
+typedef struct
+{
+  uint8_t report_id;
+  uint32_t bit_offset;
+} feature_offset_t;
+
+static uint32_t *feature_offset_for(feature_offset_t *table, int *count, uint8_t report_id)
+{
+  for (int i = 0; i < *count; i++)
+  {
+    if (table[i].report_id == report_id)
+    {
+      return &table[i].bit_offset;
+    }
+  }
+  if (*count >= MULT_MAX_FEATURE_REPORTS)
+  {
+    return NULL;
+  }
+  table[*count].report_id = report_id;
+  table[*count].bit_offset = 0;
+  return &table[(*count)++].bit_offset;
+}
+
+int parse_hid_resolution_multiplier(const void *descriptor, size_t descriptor_size,
+                                    hid_res_multiplier_t *out)
+{
+  if (!descriptor || !out)
+  {
+    return -1;
+  }
+  memset(out, 0, sizeof(*out));
+
+  mult_globals_t g;
+  memset(&g, 0, sizeof(g));
+  mult_globals_t stack[MAX_PUSH_POP_STACK];
+  int stack_size = 0;
+
+  feature_offset_t feat_offsets[MULT_MAX_FEATURE_REPORTS];
+  int feat_offset_count = 0;
+
+  // locals: 只需要知道本字段的usage里有没有0x48(Generic Desktop)
+  // 以及它是第几个usage(变量字段中usage顺序对应字段顺序)
+  uint16_t usages[MAX_USAGE_RANGES];
+  uint16_t usage_pages[MAX_USAGE_RANGES];
+  int usage_count = 0;
+
+  const uint8_t *p = (const uint8_t *)descriptor;
+  const uint8_t *q = p + descriptor_size;
+
+  while (p < q)
+  {
+    uint8_t b = *p++;
+    size_t bytes_left = q - p;
+
+    if (b == ITEM_LONG)
+    {
+      if (bytes_left < 1)
+        break;
+      p += 2 + (size_t)*p;
+      continue;
+    }
+
+    uint8_t data_size = b & ITEM_SIZE_MASK;
+    if (data_size == 3)
+      data_size = 4;
+    if (bytes_left < data_size)
+      break;
+
+    uint8_t item = b & ITEM_TAG_AND_TYPE_MASK;
+
+    switch (b & ITEM_TYPE_MASK)
+    {
+    case ITEM_TYPE_GLOBAL:
+      switch (item)
+      {
+      case ITEM_USAGE_PAGE:
+        uint16_data(p, data_size, &g.usage_page, false);
+        break;
+      case ITEM_LOGICAL_MIN:
+        int32_data(p, data_size, &g.logical_min);
+        break;
+      case ITEM_LOGICAL_MAX:
+        int32_data(p, data_size, &g.logical_max);
+        break;
+      case ITEM_PHYSICAL_MIN:
+        int32_data(p, data_size, &g.physical_min);
+        break;
+      case ITEM_PHYSICAL_MAX:
+        int32_data(p, data_size, &g.physical_max);
+        break;
+      case ITEM_REPORT_SIZE:
+        uint32_data(p, data_size, &g.report_size);
+        break;
+      case ITEM_REPORT_ID:
+        uint8_data(p, data_size, &g.report_id);
+        break;
+      case ITEM_REPORT_COUNT:
+        uint32_data(p, data_size, &g.report_count);
+        break;
+      case ITEM_PUSH:
+        if (stack_size < MAX_PUSH_POP_STACK)
+        {
+          stack[stack_size++] = g;
+        }
+        break;
+      case ITEM_POP:
+        if (stack_size > 0)
+        {
+          g = stack[--stack_size];
+        }
+        break;
+      default:
+        break;
+      }
+      break;
+
+    case ITEM_TYPE_LOCAL:
+      if (item == ITEM_USAGE && usage_count < MAX_USAGE_RANGES)
+      {
+        uint16_t usage = 0, usage_page = 0;
+        if (usage_data(p, data_size, &usage, &usage_page))
+        {
+          usages[usage_count] = usage;
+          usage_pages[usage_count] = usage_page;
+          usage_count++;
+        }
+      }
+      // USAGE_MIN/MAX范围里不会出现multiplier,忽略即可
+      break;
+
+    case ITEM_TYPE_MAIN:
+      if (item == ITEM_FEATURE)
+      {
+        uint32_t bit_size = g.report_size * g.report_count;
+        uint32_t *offset = feature_offset_for(feat_offsets, &feat_offset_count, g.report_id);
+        if (offset != NULL && bit_size > 0)
+        {
+          // 变量字段: 第i个usage对应第i个report_size宽的槽
+          for (int i = 0; i < usage_count && i < (int)g.report_count; i++)
+          {
+            uint16_t page = usage_pages[i] ? usage_pages[i] : g.usage_page;
+            if (page == PAGE_GENERIC_DESKTOP && usages[i] == USAGE_RESOLUTION_MULTIPLIER)
+            {
+              // 多个multiplier字段必须在同一个feature报告里才能一次SET启用
+              if (out->field_count == 0)
+              {
+                out->report_id = g.report_id;
+                out->logical_max = g.logical_max;
+                // Physical范围是实际倍率(如logical 0..1 -> physical 1..8),
+                // 未声明(0)时按HID规范等于logical
+                out->effective = (g.physical_max != 0) ? g.physical_max : g.logical_max;
+              }
+              if (out->report_id == g.report_id && out->field_count < HID_RES_MULT_MAX_FIELDS)
+              {
+                out->bit_offsets[out->field_count] = *offset + (uint32_t)i * g.report_size;
+                out->sizes[out->field_count] = g.report_size;
+                out->field_count++;
+              }
+            }
+          }
+          *offset += bit_size;
+        }
+      }
+      // 任何main item都清空locals
+      usage_count = 0;
+      break;
+
+    default:
+      break;
+    }
+
+    p += data_size;
+  }
+
+  if (out->field_count == 0)
+  {
+    return -1;
+  }
+
+  // 回填所在feature报告的总位数(构建SET_FEATURE缓冲用)
+  for (int i = 0; i < feat_offset_count; i++)
+  {
+    if (feat_offsets[i].report_id == out->report_id)
+    {
+      out->report_size_bits = feat_offsets[i].bit_offset;
+      break;
+    }
+  }
+  if (out->effective < 1)
+  {
+    out->effective = 1;
+  }
+  return 0;
+}
+
+/* =================================================================================================
+   输入报告ID类别扫描（O(1)分发表构建用）
+   ================================================================================================= */
+
+// collection嵌套上限(类别随嵌套继承,Application collection处重新判定)
+#define RID_MAX_COLLECTION_DEPTH 8
+
+// 根据Application Collection的(usage_page, usage)判定类别
+static uint8_t rid_class_from_usage(uint16_t usage_page, uint16_t usage)
+{
+  if (usage_page == PAGE_GENERIC_DESKTOP)
+  {
+    switch (usage)
+    {
+    case USAGE_MOUSE:
+      return HID_RID_CLASS_MOUSE;
+    case USAGE_KEYBOARD:
+    case USAGE_KEYPAD:
+      return HID_RID_CLASS_KEYBOARD;
+    case USAGE_JOYSTICK:
+    case USAGE_GAMEPAD:
+      return HID_RID_CLASS_GAMEPAD;
+    default:
+      break;
+    }
+  }
+  else if (usage_page == PAGE_CONSUMER && usage == USAGE_CONSUMER_CONTROL)
+  {
+    return HID_RID_CLASS_CONSUMER;
+  }
+  return HID_RID_CLASS_UNKNOWN;
+}
+
+int parse_hid_report_id_classes(const void *descriptor, size_t descriptor_size,
+                                hid_report_id_entry_t *entries, int max_entries)
+{
+  if (!descriptor || !entries || max_entries <= 0)
+  {
+    return 0;
+  }
+
+  uint16_t usage_page = 0;
+  uint8_t report_id = 0;
+
+  // locals: 只需要collection item前最后一个usage
+  uint16_t pending_usage = 0;
+  uint16_t pending_usage_page = 0;
+  bool pending_usage_valid = false;
+
+  // 类别随collection嵌套继承,Application collection处按usage重新判定
+  uint8_t class_stack[RID_MAX_COLLECTION_DEPTH];
+  int depth = 0;
+
+  int count = 0;
+
+  const uint8_t *p = (const uint8_t *)descriptor;
+  const uint8_t *q = p + descriptor_size;
+
+  while (p < q)
+  {
+    uint8_t b = *p++;
+    size_t bytes_left = q - p;
+
+    if (b == ITEM_LONG)
+    {
+      if (bytes_left < 1)
+        break;
+      p += 2 + (size_t)*p;
+      continue;
+    }
+
+    uint8_t data_size = b & ITEM_SIZE_MASK;
+    if (data_size == 3)
+      data_size = 4;
+    if (bytes_left < data_size)
+      break;
+
+    uint8_t item = b & ITEM_TAG_AND_TYPE_MASK;
+
+    switch (b & ITEM_TYPE_MASK)
+    {
+    case ITEM_TYPE_GLOBAL:
+      if (item == ITEM_USAGE_PAGE)
+      {
+        uint16_data(p, data_size, &usage_page, false);
+      }
+      else if (item == ITEM_REPORT_ID)
+      {
+        uint8_data(p, data_size, &report_id);
+      }
+      break;
+
+    case ITEM_TYPE_LOCAL:
+      if (item == ITEM_USAGE)
+      {
+        uint16_t usage = 0, page = 0;
+        if (usage_data(p, data_size, &usage, &page))
+        {
+          pending_usage = usage;
+          pending_usage_page = page ? page : usage_page;
+          pending_usage_valid = true;
+        }
+      }
+      break;
+
+    case ITEM_TYPE_MAIN:
+      if (item == ITEM_COLLECTION)
+      {
+        uint8_t coll_type = 0;
+        uint8_data(p, data_size, &coll_type);
+        uint8_t cls = (depth > 0) ? class_stack[depth - 1] : HID_RID_CLASS_UNKNOWN;
+        if (coll_type == COLLECTION_TYPE_APPLICATION && pending_usage_valid)
+        {
+          cls = rid_class_from_usage(pending_usage_page, pending_usage);
+        }
+        if (depth < RID_MAX_COLLECTION_DEPTH)
+        {
+          class_stack[depth] = cls;
+        }
+        depth++;
+      }
+      else if (item == ITEM_END_COLLECTION)
+      {
+        if (depth > 0)
+        {
+          depth--;
+        }
+      }
+      else if (item == ITEM_INPUT)
+      {
+        uint8_t cls = (depth > 0 && depth <= RID_MAX_COLLECTION_DEPTH)
+                          ? class_stack[depth - 1]
+                          : HID_RID_CLASS_UNKNOWN;
+        // 同一个报告ID只记录一次,类别取第一个非UNKNOWN的collection
+        int found = -1;
+        for (int i = 0; i < count; i++)
+        {
+          if (entries[i].report_id == report_id)
+          {
+            found = i;
+            break;
+          }
+        }
+        if (found >= 0)
+        {
+          if (entries[found].rid_class == HID_RID_CLASS_UNKNOWN)
+          {
+            entries[found].rid_class = cls;
+          }
+        }
+        else if (count < max_entries)
+        {
+          entries[count].report_id = report_id;
+          entries[count].rid_class = cls;
+          count++;
+        }
+      }
+      // 任何main item都清空locals
+      pending_usage_valid = false;
+      break;
+
+    default:
+      break;
+    }
+
+    p += data_size;
+  }
+
+  return count;
+}
+
+/* =================================================================================================
+   手柄输入布局扫描（Joystick/Gamepad Application Collection）
+   ================================================================================================= */
+
+// 轴usage(Generic Desktop)到轴槽位的映射(顺序与BLE gamepad报告一致)
+static int gamepad_axis_slot(uint16_t usage)
+{
+  switch (usage)
+  {
+  case USAGE_X:
+    return 0;
+  case USAGE_Y:
+    return 1;
+  case USAGE_Z:
+    return 2;
+  case USAGE_RZ:
+    return 3;
+  case USAGE_RX:
+    return 4;
+  case USAGE_RY:
+    return 5;
+  default:
+    return -1;
+  }
+}
+
+int parse_hid_gamepad_layout(const void *descriptor, size_t descriptor_size,
+                             hid_gamepad_layout_t *out)
+{
+  if (!descriptor || !out)
+  {
+    return -1;
+  }
+  memset(out, 0, sizeof(*out));
+
+  mult_globals_t g;
+  memset(&g, 0, sizeof(g));
+  mult_globals_t stack[MAX_PUSH_POP_STACK];
+  int stack_size = 0;
+
+  // 每个输入报告ID独立的位偏移计数(字段可能跨collection分布)
+  feature_offset_t in_offsets[MULT_MAX_FEATURE_REPORTS];
+  int in_offset_count = 0;
+
+  // locals: 单个usage列表 + 按钮声明常用的usage范围
+  uint16_t usages[MAX_USAGE_RANGES];
+  uint16_t usage_pages[MAX_USAGE_RANGES];
+  int usage_count = 0;
+  uint16_t range_page = 0;
+  uint8_t range_flags = 0;
+
+  int depth = 0;
+  int pad_depth = -1;  // 手柄Application collection的深度(-1=不在其中)
+  bool found = false;  // 是否已锁定报告ID(第一个带手柄字段的输入报告)
+
+  const uint8_t *p = (const uint8_t *)descriptor;
+  const uint8_t *q = p + descriptor_size;
+
+  while (p < q)
+  {
+    uint8_t b = *p++;
+    size_t bytes_left = q - p;
+
+    if (b == ITEM_LONG)
+    {
+      if (bytes_left < 1)
+        break;
+      p += 2 + (size_t)*p;
+      continue;
+    }
+
+    uint8_t data_size = b & ITEM_SIZE_MASK;
+    if (data_size == 3)
+      data_size = 4;
+    if (bytes_left < data_size)
+      break;
+
+    uint8_t item = b & ITEM_TAG_AND_TYPE_MASK;
+
+    switch (b & ITEM_TYPE_MASK)
+    {
+    case ITEM_TYPE_GLOBAL:
+      switch (item)
+      {
+      case ITEM_USAGE_PAGE:
+        uint16_data(p, data_size, &g.usage_page, false);
+        break;
+      case ITEM_LOGICAL_MIN:
+        int32_data(p, data_size, &g.logical_min);
+        break;
+      case ITEM_LOGICAL_MAX:
+        int32_data(p, data_size, &g.logical_max);
+        break;
+      case ITEM_REPORT_SIZE:
+        uint32_data(p, data_size, &g.report_size);
+        break;
+      case ITEM_REPORT_ID:
+        uint8_data(p, data_size, &g.report_id);
+        break;
+      case ITEM_REPORT_COUNT:
+        uint32_data(p, data_size, &g.report_count);
+        break;
+      case ITEM_PUSH:
+        if (stack_size < MAX_PUSH_POP_STACK)
+        {
+          stack[stack_size++] = g;
+        }
+        break;
+      case ITEM_POP:
+        if (stack_size > 0)
+        {
+          g = stack[--stack_size];
+        }
+        break;
+      default:
+        break;
+      }
+      break;
+
+    case ITEM_TYPE_LOCAL:
+      if (item == ITEM_USAGE && usage_count < MAX_USAGE_RANGES)
+      {
+        uint16_t usage = 0, usage_page = 0;
+        if (usage_data(p, data_size, &usage, &usage_page))
+        {
+          usages[usage_count] = usage;
+          usage_pages[usage_count] = usage_page;
+          usage_count++;
+        }
+      }
+      else if (item == ITEM_USAGE_MIN || item == ITEM_USAGE_MAX)
+      {
+        // 按钮字段通常用Usage Min/Max声明;只需要知道范围所在的页
+        uint16_t v = 0, vp = 0;
+        usage_data(p, data_size, &v, &vp);
+        range_page = vp ? vp : 0;
+        range_flags |= (item == ITEM_USAGE_MIN) ? FLAG_USAGE_MIN : FLAG_USAGE_MAX;
+      }
+      break;
+
+    case ITEM_TYPE_MAIN:
+      if (item == ITEM_COLLECTION)
+      {
+        depth++;
+        if (pad_depth < 0 && usage_count > 0 && data_size > 0 &&
+            p[0] == COLLECTION_TYPE_APPLICATION)
+        {
+          uint16_t page = usage_pages[0] ? usage_pages[0] : g.usage_page;
+          if (page == PAGE_GENERIC_DESKTOP &&
+              (usages[0] == USAGE_JOYSTICK || usages[0] == USAGE_GAMEPAD))
+          {
+            pad_depth = depth;
+          }
+        }
+      }
+      else if (item == ITEM_END_COLLECTION)
+      {
+        if (depth == pad_depth)
+        {
+          pad_depth = -1;
+        }
+        if (depth > 0)
+        {
+          depth--;
+        }
+      }
+      else if (item == ITEM_INPUT)
+      {
+        uint32_t bit_size = g.report_size * g.report_count;
+        uint32_t *offset = feature_offset_for(in_offsets, &in_offset_count, g.report_id);
+        if (offset != NULL && bit_size > 0)
+        {
+          // 只记录手柄collection内、且属于锁定报告ID的字段
+          if (pad_depth >= 0 && (!found || out->report_id == g.report_id))
+          {
+            uint16_t btn_page = range_page ? range_page : g.usage_page;
+            if ((range_flags & (FLAG_USAGE_MIN | FLAG_USAGE_MAX)) ==
+                    (FLAG_USAGE_MIN | FLAG_USAGE_MAX) &&
+                btn_page == PAGE_BUTTON && out->buttons_count == 0)
+            {
+              found = true;
+              out->report_id = g.report_id;
+              out->buttons_bit_offset = *offset;
+              out->buttons_count = g.report_count;
+            }
+
+            // 变量字段: 第i个usage对应第i个report_size宽的槽
+            for (int i = 0; i < usage_count && i < (int)g.report_count; i++)
+            {
+              uint16_t page = usage_pages[i] ? usage_pages[i] : g.usage_page;
+              if (page != PAGE_GENERIC_DESKTOP)
+              {
+                continue;
+              }
+              int slot = gamepad_axis_slot(usages[i]);
+              if (slot >= 0 && out->axes[slot].size == 0)
+              {
+                found = true;
+                out->report_id = g.report_id;
+                out->axes[slot].bit_offset = *offset + (uint32_t)i * g.report_size;
+                out->axes[slot].size = g.report_size;
+                out->axes[slot].logical_min = g.logical_min;
+                out->axes[slot].logical_max = g.logical_max;
+              }
+              else if (usages[i] == USAGE_HAT_SWITCH && out->hat.size == 0)
+              {
+                found = true;
+                out->report_id = g.report_id;
+                out->hat.bit_offset = *offset + (uint32_t)i * g.report_size;
+                out->hat.size = g.report_size;
+                out->hat.logical_min = g.logical_min;
+                out->hat.logical_max = g.logical_max;
+              }
+            }
+          }
+          *offset += bit_size;
+        }
+      }
+      // 任何main item都清空locals
+      usage_count = 0;
+      range_page = 0;
+      range_flags = 0;
+      break;
+
+    default:
+      break;
+    }
+
+    p += data_size;
+  }
+
+  if (!found)
+  {
+    return -1;
+  }
+
+  // 回填所在输入报告的总位数(热路径长度检查用)
+  for (int i = 0; i < in_offset_count; i++)
+  {
+    if (in_offsets[i].report_id == out->report_id)
+    {
+      out->report_size_bits = in_offsets[i].bit_offset;
+      break;
+    }
+  }
+  return 0;
+}
+
+/* =================================================================================================
+   预编译提取计划（hot path优化）
+   ================================================================================================= */
+
+// 编译单个字段：把位偏移转换为字节偏移/位移/掩码，并选择提取路径
+static void compile_field(hid_field_plan_t *f, uint32_t bit_offset, uint32_t bit_size, bool is_signed)
+{
+  memset(f, 0, sizeof(*f));
+
+  if (bit_size == 0 || bit_size > 32)
+  {
+    f->kind = HID_FIELD_NONE;
+    return;
+  }
+
+  f->byte_offset = (uint8_t)(bit_offset / 8);
+  f->shift = (uint8_t)(bit_offset % 8);
+  f->bit_size = (uint8_t)bit_size;
+  f->mask = (bit_size >= 32) ? 0xFFFFFFFFu : ((1u << bit_size) - 1u);
+
+  if (is_signed)
+  {
+    f->sign_bit = 1u << (bit_size - 1);
+    f->sign_ext = (bit_size >= 32) ? 0 : ((~0u) << bit_size);
+  }
+
+  // 字节对齐的8/16位字段走专用快速路径（覆盖几乎所有真实鼠标）
+  if (f->shift == 0 && bit_size == 8)
+  {
+    f->kind = HID_FIELD_BYTE_8;
+  }
+  else if (f->shift == 0 && bit_size == 16)
+  {
+    f->kind = HID_FIELD_BYTE_16;
+  }
+  else
+  {
+    f->kind = HID_FIELD_GENERIC;
+  }
+}
+
+void hid_report_plan_compile(const hid_report_layout_t *layout, hid_report_plan_t *plan)
+{
+  if (!layout || !plan)
+  {
+    return;
+  }
+
+  memset(plan, 0, sizeof(*plan));
+  plan->report_id = layout->report_id;
+  plan->report_class = (uint8_t)hid_report_layout_classify(layout);
+
+  // layout中的位偏移是相对于报告数据开始的（不包括report_id）
+  // plan中的偏移直接包含report_id字节的调整，使热路径无需再计算
+  uint32_t adjust = (layout->report_id != 0) ? 8 : 0;
+
+  compile_field(&plan->buttons, layout->buttons_bit_offset + adjust, layout->buttons_count, false);
+  compile_field(&plan->x, layout->x_bit_offset + adjust, layout->x_size, true);
+  compile_field(&plan->y, layout->y_bit_offset + adjust, layout->y_size, true);
+  compile_field(&plan->wheel, layout->wheel_bit_offset + adjust, layout->wheel_size, true);
+  compile_field(&plan->pan, layout->pan_bit_offset + adjust, layout->pan_size, true);
+
+  plan->min_length = (uint8_t)((layout->report_size_bits + adjust + 7) / 8);
+}
+
+void hid_gamepad_plan_compile(const hid_gamepad_layout_t *layout, hid_gamepad_plan_t *plan)
+{
+  if (!layout || !plan)
+  {
+    return;
+  }
+
+  memset(plan, 0, sizeof(*plan));
+  plan->report_id = layout->report_id;
+
+  uint32_t adjust = (layout->report_id != 0) ? 8 : 0;
+
+  for (int i = 0; i < HID_GAMEPAD_AXES; i++)
+  {
+    const hid_gamepad_field_t *a = &layout->axes[i];
+    if (a->size == 0)
+    {
+      continue;
+    }
+    // logical_min<0按有符号编译(符号扩展进plan);
+    // 无符号轴(常见0..255中心128)减center归零,再右移缩到8位量程
+    bool is_signed = (a->logical_min < 0);
+    compile_field(&plan->axes[i], a->bit_offset + adjust, a->size, is_signed);
+    if (!is_signed)
+    {
+      plan->axis_center[i] = (a->logical_max > 0)
+                                 ? (a->logical_max + a->logical_min + 1) / 2
+                                 : (int32_t)(1u << (a->size - 1));
+    }
+    plan->axis_downshift[i] = (a->size > 8) ? (uint8_t)(a->size - 8) : 0;
+  }
+
+  compile_field(&plan->hat, layout->hat.bit_offset + adjust, layout->hat.size, false);
+  plan->hat_min = layout->hat.logical_min;
+
+  uint32_t btn_bits = (layout->buttons_count > 32) ? 32 : layout->buttons_count;
+  compile_field(&plan->buttons, layout->buttons_bit_offset + adjust, btn_bits, false);
+
+  plan->min_length = (uint8_t)((layout->report_size_bits + adjust + 7) / 8);
+}
+
+/* =================================================================================================
+   消费类输入布局扫描（Consumer Control Application Collection）
+   ================================================================================================= */
+
+int parse_hid_consumer_layout(const void *descriptor, size_t descriptor_size,
+                              hid_consumer_layout_t *out)
+{
+  if (!descriptor || !out)
+  {
+    return -1;
+  }
+  memset(out, 0, sizeof(*out));
+
+  mult_globals_t g;
+  memset(&g, 0, sizeof(g));
+  mult_globals_t stack[MAX_PUSH_POP_STACK];
+  int stack_size = 0;
+
+  feature_offset_t in_offsets[MULT_MAX_FEATURE_REPORTS];
+  int in_offset_count = 0;
+
+  // locals: 单个usage列表 + usage范围(位图和数组都常用Min/Max声明)
+  uint16_t usages[MAX_USAGE_RANGES];
+  uint16_t usage_pages[MAX_USAGE_RANGES];
+  int usage_count = 0;
+  uint16_t range_page = 0;
+  uint16_t range_min = 0;
+  uint16_t range_max = 0;
+  uint8_t range_flags = 0;
+
+  int depth = 0;
+  int cc_depth = -1;  // Consumer Control Application collection的深度
+  bool found = false; // 是否已锁定报告ID
+
+  const uint8_t *p = (const uint8_t *)descriptor;
+  const uint8_t *q = p + descriptor_size;
+
+  while (p < q)
+  {
+    uint8_t b = *p++;
+    size_t bytes_left = q - p;
+
+    if (b == ITEM_LONG)
+    {
+      if (bytes_left < 1)
+        break;
+      p += 2 + (size_t)*p;
+      continue;
+    }
+
+    uint8_t data_size = b & ITEM_SIZE_MASK;
+    if (data_size == 3)
+      data_size = 4;
+    if (bytes_left < data_size)
+      break;
+
+    uint8_t item = b & ITEM_TAG_AND_TYPE_MASK;
+
+    switch (b & ITEM_TYPE_MASK)
+    {
+    case ITEM_TYPE_GLOBAL:
+      switch (item)
+      {
+      case ITEM_USAGE_PAGE:
+        uint16_data(p, data_size, &g.usage_page, false);
+        break;
+      case ITEM_LOGICAL_MIN:
+        int32_data(p, data_size, &g.logical_min);
+        break;
+      case ITEM_LOGICAL_MAX:
+        int32_data(p, data_size, &g.logical_max);
+        break;
+      case ITEM_REPORT_SIZE:
+        uint32_data(p, data_size, &g.report_size);
+        break;
+      case ITEM_REPORT_ID:
+        uint8_data(p, data_size, &g.report_id);
+        break;
+      case ITEM_REPORT_COUNT:
+        uint32_data(p, data_size, &g.report_count);
+        break;
+      case ITEM_PUSH:
+        if (stack_size < MAX_PUSH_POP_STACK)
+        {
+          stack[stack_size++] = g;
+        }
+        break;
+      case ITEM_POP:
+        if (stack_size > 0)
+        {
+          g = stack[--stack_size];
+        }
+        break;
+      default:
+        break;
+      }
+      break;
+
+    case ITEM_TYPE_LOCAL:
+      if (item == ITEM_USAGE && usage_count < MAX_USAGE_RANGES)
+      {
+        uint16_t usage = 0, usage_page = 0;
+        if (usage_data(p, data_size, &usage, &usage_page))
+        {
+          usages[usage_count] = usage;
+          usage_pages[usage_count] = usage_page;
+          usage_count++;
+        }
+      }
+      else if (item == ITEM_USAGE_MIN || item == ITEM_USAGE_MAX)
+      {
+        // 消费类需要范围的实际值: 位图的第i位/数组的槽值都要映射回usage
+        uint16_t v = 0, vp = 0;
+        usage_data(p, data_size, &v, &vp);
+        range_page = vp ? vp : range_page;
+        if (item == ITEM_USAGE_MIN)
+        {
+          range_min = v;
+          range_flags |= FLAG_USAGE_MIN;
+        }
+        else
+        {
+          range_max = v;
+          range_flags |= FLAG_USAGE_MAX;
+        }
+      }
+      break;
+
+    case ITEM_TYPE_MAIN:
+      if (item == ITEM_COLLECTION)
+      {
+        depth++;
+        if (cc_depth < 0 && usage_count > 0 && data_size > 0 &&
+            p[0] == COLLECTION_TYPE_APPLICATION)
+        {
+          uint16_t page = usage_pages[0] ? usage_pages[0] : g.usage_page;
+          if (page == PAGE_CONSUMER && usages[0] == USAGE_CONSUMER_CONTROL)
+          {
+            cc_depth = depth;
+          }
+        }
+      }
+      else if (item == ITEM_END_COLLECTION)
+      {
+        if (depth == cc_depth)
+        {
+          cc_depth = -1;
+        }
+        if (depth > 0)
+        {
+          depth--;
+        }
+      }
+      else if (item == ITEM_INPUT)
+      {
+        uint32_t bit_size = g.report_size * g.report_count;
+        uint32_t *offset = feature_offset_for(in_offsets, &in_offset_count, g.report_id);
+        if (offset != NULL && bit_size > 0)
+        {
+          bool is_variable = data_size > 0 && (p[0] & FLAG_FIELD_VARIABLE) != 0;
+          uint32_t adjust = (g.report_id != 0) ? 8 : 0;
+          uint16_t fld_page = range_page ? range_page : g.usage_page;
+
+          // 只记录Consumer collection内、且属于锁定报告ID的字段
+          if (cc_depth >= 0 && (!found || out->report_id == g.report_id))
+          {
+            if (is_variable)
+            {
+              // 位图: 第i个槽对应列表第i个usage,或范围的usage_min+i
+              bool has_range = (range_flags & (FLAG_USAGE_MIN | FLAG_USAGE_MAX)) ==
+                               (FLAG_USAGE_MIN | FLAG_USAGE_MAX);
+              for (uint32_t i = 0; i < g.report_count &&
+                                   out->bit_count < HID_CONSUMER_MAX_BITS;
+                   i++)
+              {
+                uint16_t usage, page;
+                if ((int)i < usage_count)
+                {
+                  usage = usages[i];
+                  page = usage_pages[i] ? usage_pages[i] : g.usage_page;
+                }
+                else if (has_range && range_min + i <= range_max)
+                {
+                  usage = (uint16_t)(range_min + i);
+                  page = fld_page;
+                }
+                else
+                {
+                  break;
+                }
+                if (page != PAGE_CONSUMER)
+                {
+                  continue;
+                }
+                found = true;
+                out->report_id = g.report_id;
+                hid_consumer_bit_t *bit = &out->bits[out->bit_count++];
+                bit->usage = usage;
+                compile_field(&bit->field, *offset + i * g.report_size + adjust,
+                              g.report_size, false);
+              }
+            }
+            else if ((range_flags & (FLAG_USAGE_MIN | FLAG_USAGE_MAX)) ==
+                         (FLAG_USAGE_MIN | FLAG_USAGE_MAX) &&
+                     fld_page == PAGE_CONSUMER)
+            {
+              // 数组: 每个槽独立记录,槽值映射回usage范围
+              for (uint32_t i = 0; i < g.report_count &&
+                                   out->array_count < HID_CONSUMER_MAX_ARRAYS;
+                   i++)
+              {
+                found = true;
+                out->report_id = g.report_id;
+                hid_consumer_array_t *arr = &out->arrays[out->array_count++];
+                compile_field(&arr->field, *offset + i * g.report_size + adjust,
+                              g.report_size, false);
+                arr->logical_min = g.logical_min;
+                arr->usage_min = range_min;
+                arr->usage_max = range_max;
+              }
+            }
+          }
+          *offset += bit_size;
+        }
+      }
+      // 任何main item都清空locals
+      usage_count = 0;
+      range_page = 0;
+      range_min = 0;
+      range_max = 0;
+      range_flags = 0;
+      break;
+
+    default:
+      break;
+    }
+
+    p += data_size;
+  }
+
+  if (!found)
+  {
+    return -1;
+  }
+
+  // 回填最小包长(热路径长度检查用)
+  for (int i = 0; i < in_offset_count; i++)
+  {
+    if (in_offsets[i].report_id == out->report_id)
+    {
+      uint32_t adjust = (out->report_id != 0) ? 8 : 0;
+      out->min_length = (uint8_t)((in_offsets[i].bit_offset + adjust + 7) / 8);
+      break;
+    }
+  }
+  return 0;
+}
+
+/* =================================================================================================
+   设备类别分类（枚举阶段一次性判定）
+   ================================================================================================= */
+
+// 字段是否字节对齐且为8/16位（对应BYTE_8/BYTE_16快速路径）
+static bool field_is_aligned(uint32_t bit_offset, uint32_t bit_size)
+{
+  return (bit_offset % 8) == 0 && (bit_size == 8 || bit_size == 16);
+}
+
+hid_report_class_t hid_report_layout_classify(const hid_report_layout_t *layout)
+{
+  if (!layout || (layout->x_size == 0 && layout->y_size == 0))
+  {
+    return HID_REPORT_CLASS_UNKNOWN;
+  }
+
+  // 任一存在的字段非字节对齐就只能走GENERIC提取
+  if ((layout->x_size > 0 && !field_is_aligned(layout->x_bit_offset, layout->x_size)) ||
+      (layout->y_size > 0 && !field_is_aligned(layout->y_bit_offset, layout->y_size)) ||
+      (layout->wheel_size > 0 && !field_is_aligned(layout->wheel_bit_offset, layout->wheel_size)) ||
+      (layout->pan_size > 0 && !field_is_aligned(layout->pan_bit_offset, layout->pan_size)) ||
+      (layout->buttons_count > 0 && (layout->buttons_bit_offset % 8) != 0))
+  {
+    return HID_REPORT_CLASS_MOUSE_GENERIC;
+  }
+
+  // 扩展能力: 16位轴、水平滚轮(倾斜滚轮)或5键以上
+  if (layout->x_size == 16 || layout->y_size == 16 ||
+      layout->pan_size > 0 || layout->buttons_count > 5)
+  {
+    return HID_REPORT_CLASS_MOUSE_EXT;
+  }
+
+  // 经典Boot形态: 8位X/Y,<=3键
+  if (layout->x_size == 8 && layout->y_size == 8 && layout->buttons_count <= 3)
+  {
+    return HID_REPORT_CLASS_MOUSE_BOOT;
+  }
+
+  return HID_REPORT_CLASS_MOUSE_STD;
+}
+
+const char *hid_report_class_name(hid_report_class_t cls)
+{
+  switch (cls)
+  {
+  case HID_REPORT_CLASS_MOUSE_BOOT:
+    return "mouse-boot";
+  case HID_REPORT_CLASS_MOUSE_STD:
+    return "mouse-std";
+  case HID_REPORT_CLASS_MOUSE_EXT:
+    return "mouse-ext";
+  case HID_REPORT_CLASS_MOUSE_GENERIC:
+    return "mouse-generic";
+  default:
+    return "unknown";
+  }
+}
@@ -19,11 +19,22 @@ extern "C"
 
 // Generic Desktop Page usages
 #define USAGE_MOUSE 0x02
+#define USAGE_JOYSTICK 0x04
+#define USAGE_GAMEPAD 0x05
+#define USAGE_KEYBOARD 0x06
+#define USAGE_KEYPAD 0x07
 #define USAGE_X 0x30
 #define USAGE_Y 0x31
+#define USAGE_Z 0x32
+#define USAGE_RX 0x33
+#define USAGE_RY 0x34
+#define USAGE_RZ 0x35
 #define USAGE_WHEEL 0x38
+#define USAGE_HAT_SWITCH 0x39
+#define USAGE_RESOLUTION_MULTIPLIER 0x48
 
 // Consumer Page usages
+#define USAGE_CONSUMER_CONTROL 0x01
 #define USAGE_CONSUMER_AC_PAN 0x0238
 
 // Collection types
@@ -53,6 +64,304 @@ extern "C"
     uint32_t pan_size;       // Size in bits of pan
   } hid_report_layout_t;
 
+  // 字段提取方式（编译plan时根据字段对齐情况选择）
+  // 绝大多数真实鼠标的字段都是字节对齐的8/16位，走专用快速路径
+  typedef enum
+  {
+    HID_FIELD_NONE = 0,  // 字段不存在（提取时返回0）
+    HID_FIELD_BYTE_8,    // 字节对齐8位
+    HID_FIELD_BYTE_16,   // 字节对齐16位（little-endian）
+    HID_FIELD_GENERIC,   // 通用路径：按字节读取后移位+掩码
+  } hid_field_kind_t;
+
+  // 单个字段的预编译提取计划
+  // 所有偏移都是相对于数据包开始（包括report_id字节，如果存在）
+  typedef struct
+  {
+    uint8_t kind;        // hid_field_kind_t
+    uint8_t byte_offset; // 字段起始字节
+    uint8_t shift;       // 字节内位移（GENERIC路径）
+    uint8_t bit_size;    // 字段位宽
+    uint32_t mask;       // 值掩码（GENERIC路径）
+    uint32_t sign_bit;   // 符号位（0表示无符号字段）
+    uint32_t sign_ext;   // 符号扩展掩码
+  } hid_field_plan_t;
+
+  // 设备类别（枚举阶段从layout分类一次，热路径按类别走对应分支）
+  // 分类依据是编译后的提取路径和字段能力，而不是设备自称的协议
+  typedef enum
+  {
+    HID_REPORT_CLASS_UNKNOWN = 0,
+    HID_REPORT_CLASS_MOUSE_BOOT,    // 8位X/Y字节对齐，<=3键（经典Boot鼠标）
+    HID_REPORT_CLASS_MOUSE_STD,     // 8/16位字节对齐，<=5键，无水平滚轮
+    HID_REPORT_CLASS_MOUSE_EXT,     // 16位轴/AC Pan(倾斜滚轮)/更多按钮
+    HID_REPORT_CLASS_MOUSE_GENERIC, // 存在非字节对齐字段，走GENERIC提取
+  } hid_report_class_t;
+
+  // 整个报告的预编译提取计划（编译自 hid_report_layout_t）
+  typedef struct
+  {
+    uint8_t report_id; // Report ID (0 means no report ID)
+    uint8_t min_length; // 数据包最小字节数（提取前的长度检查）
+    uint8_t report_class;     // hid_report_class_t（编译时分类）
+    hid_field_plan_t buttons; // 无符号
+    hid_field_plan_t x;       // 有符号
+    hid_field_plan_t y;       // 有符号
+    hid_field_plan_t wheel;   // 有符号
+    hid_field_plan_t pan;     // 有符号（水平滚轮/倾斜滚轮，AC Pan）
+  } hid_report_plan_t;
+
+  /**
+   * @brief Compile a parsed layout into a precomputed extraction plan
+   *
+   * 在枚举阶段调用一次，把layout的位偏移转换为字节偏移/位移/掩码/符号扩展常量，
+   * 使每个报告的热路径提取只剩几次load和移位。
+   * report_id存在时（非0），plan内的偏移已经包含跳过report_id字节的调整。
+   *
+   * @param layout Parsed layout (from parse_hid_report_descriptor_layouts)
+   * @param plan Output plan
+   */
+  void hid_report_plan_compile(const hid_report_layout_t *layout, hid_report_plan_t *plan);
+
+  /**
+   * @brief Classify a parsed layout into a device class
+   *
+   * 枚举阶段调用一次，根据字段宽度/对齐/能力把layout归入设备类别；
+   * hid_report_plan_compile内部也会调用并把结果写入plan->report_class
+   *
+   * @param layout Parsed layout
+   * @return Device class (HID_REPORT_CLASS_UNKNOWN if layout has no mouse fields)
+   */
+  hid_report_class_t hid_report_layout_classify(const hid_report_layout_t *layout);
+
+  /**
+   * @brief Human-readable name for a device class (logging helper)
+   */
+  const char *hid_report_class_name(hid_report_class_t cls);
+
+  /**
+   * @brief Extract an unsigned field using a precompiled plan (hot path)
+   */
+  static inline uint32_t hid_field_extract_u32(const hid_field_plan_t *f, const uint8_t *data, int data_len)
+  {
+    switch (f->kind)
+    {
+    case HID_FIELD_BYTE_8:
+      if (f->byte_offset < data_len)
+        return data[f->byte_offset];
+      return 0;
+    case HID_FIELD_BYTE_16:
+      if (f->byte_offset + 1 < data_len)
+        return (uint32_t)data[f->byte_offset] | ((uint32_t)data[f->byte_offset + 1] << 8);
+      return 0;
+    case HID_FIELD_GENERIC:
+    {
+      // 读取覆盖字段的字节（最多5字节，支持跨字节边界的<=32位字段）
+      uint64_t v = 0;
+      int nbytes = (f->shift + f->bit_size + 7) / 8;
+      for (int i = 0; i < nbytes && (f->byte_offset + i) < data_len; i++)
+      {
+        v |= (uint64_t)data[f->byte_offset + i] << (8 * i);
+      }
+      return (uint32_t)(v >> f->shift) & f->mask;
+    }
+    default:
+      return 0;
+    }
+  }
+
+  /**
+   * @brief Extract a signed field using a precompiled plan (hot path)
+   */
+  static inline int32_t hid_field_extract_s32(const hid_field_plan_t *f, const uint8_t *data, int data_len)
+  {
+    uint32_t u = hid_field_extract_u32(f, data, data_len);
+    if (u & f->sign_bit)
+    {
+      return (int32_t)(u | f->sign_ext);
+    }
+    return (int32_t)u;
+  }
+
+  // 输入报告ID的类别(按所在Application Collection的usage分类)
+  // 枚举阶段扫描一次,热路径按report_id直接索引分发,不再做长度启发式
+  typedef enum
+  {
+    HID_RID_CLASS_UNKNOWN = 0, // 未识别的collection(走generic处理)
+    HID_RID_CLASS_MOUSE,       // Generic Desktop / Mouse
+    HID_RID_CLASS_KEYBOARD,    // Generic Desktop / Keyboard或Keypad
+    HID_RID_CLASS_CONSUMER,    // Consumer / Consumer Control(媒体键)
+    HID_RID_CLASS_GAMEPAD,     // Generic Desktop / Joystick或Gamepad
+  } hid_report_id_class_t;
+
+// 单个descriptor里最多记录的输入报告ID数
+#define HID_REPORT_ID_CLASS_MAX 16
+
+  // 一个输入报告ID及其类别
+  typedef struct
+  {
+    uint8_t report_id; // 0表示描述符没有report_id
+    uint8_t rid_class; // hid_report_id_class_t
+  } hid_report_id_entry_t;
+
+  /**
+   * @brief Scan descriptor and classify input report IDs by application collection
+   *
+   * 记录每个含INPUT字段的报告ID及其所在Application Collection的类别
+   * (鼠标/键盘/消费类媒体键/手柄),同一个报告ID只记录一次,
+   * 类别取第一个识别出的非UNKNOWN collection
+   *
+   * @param descriptor Pointer to HID report descriptor
+   * @param descriptor_size Size of descriptor in bytes
+   * @param entries Output array
+   * @param max_entries Capacity of entries
+   * @return Number of entries recorded (0 on error)
+   */
+  int parse_hid_report_id_classes(const void *descriptor, size_t descriptor_size,
+                                  hid_report_id_entry_t *entries, int max_entries);
+
+// 手柄轴槽位数(顺序与BLE gamepad报告一致: X,Y,Z,Rz,Rx,Ry)
+#define HID_GAMEPAD_AXES 6
+
+  // 手柄布局的单个字段(轴/帽开关)
+  typedef struct
+  {
+    uint32_t bit_offset; // 位偏移(不含report_id字节)
+    uint32_t size;       // 位宽(0表示字段不存在)
+    int32_t logical_min; // 逻辑最小值(判定有符号/中心偏置用)
+    int32_t logical_max; // 逻辑最大值
+  } hid_gamepad_field_t;
+
+  // 手柄输入报告布局(第一个Joystick/Gamepad Application Collection)
+  typedef struct
+  {
+    uint8_t report_id;         // Report ID (0 means no report ID)
+    uint32_t report_size_bits; // 该报告总位数(不含report_id字节)
+    hid_gamepad_field_t axes[HID_GAMEPAD_AXES]; // 轴字段(槽位见上)
+    hid_gamepad_field_t hat;                    // 帽开关(Hat Switch)
+    uint32_t buttons_count;      // 按钮位数
+    uint32_t buttons_bit_offset; // 按钮字段位偏移
+  } hid_gamepad_layout_t;
+
+  // 手柄报告的预编译提取计划(编译自 hid_gamepad_layout_t)
+  // 轴值归一到int8: 先提取(plan含符号扩展),减center(无符号中心偏置轴),
+  // 再右移downshift(>8位的轴缩到8位量程)
+  typedef struct
+  {
+    uint8_t report_id;
+    uint8_t min_length; // 数据包最小字节数
+    hid_field_plan_t axes[HID_GAMEPAD_AXES];
+    int32_t axis_center[HID_GAMEPAD_AXES];  // 无符号轴的中心值(有符号轴为0)
+    uint8_t axis_downshift[HID_GAMEPAD_AXES]; // 缩到8位的右移位数
+    hid_field_plan_t hat;
+    int32_t hat_min; // 帽开关逻辑最小值(转成1..8,越界为0)
+    hid_field_plan_t buttons; // 最多32位
+  } hid_gamepad_plan_t;
+
+  /**
+   * @brief Scan descriptor for a joystick/gamepad input report layout
+   *
+   * 轻量扫描: 记录第一个Joystick/Gamepad Application Collection里
+   * 输入报告的轴(X/Y/Z/Rx/Ry/Rz)/帽开关/按钮字段位置和逻辑范围,
+   * 供重采样器在枚举阶段编译提取计划
+   *
+   * @param descriptor Pointer to HID report descriptor
+   * @param descriptor_size Size of descriptor in bytes
+   * @param out Output layout
+   * @return 0 if a gamepad input report was found, -1 otherwise
+   */
+  int parse_hid_gamepad_layout(const void *descriptor, size_t descriptor_size,
+                               hid_gamepad_layout_t *out);
+
+  /**
+   * @brief Compile a gamepad layout into a precomputed extraction plan
+   *
+   * @param layout Parsed layout (from parse_hid_gamepad_layout)
+   * @param plan Output plan (offsets already adjusted for the report_id byte)
+   */
+  void hid_gamepad_plan_compile(const hid_gamepad_layout_t *layout, hid_gamepad_plan_t *plan);
+
+// 消费类(媒体键)布局最多记录的字段数
+// 多媒体键盘常见形态: 一个usage位图(每键1位)或一个16位usage数组
+#define HID_CONSUMER_MAX_BITS 24
+#define HID_CONSUMER_MAX_ARRAYS 4
+
+  // 位图字段里的单个位: 置位表示对应usage按下
+  typedef struct
+  {
+    uint16_t usage;         // Consumer Page usage ID
+    hid_field_plan_t field; // 1位提取计划(偏移已含report_id字节)
+  } hid_consumer_bit_t;
+
+  // 数组字段: 槽值即usage索引,usage = usage_min + (值 - logical_min)
+  typedef struct
+  {
+    hid_field_plan_t field; // 槽提取计划(偏移已含report_id字节)
+    int32_t logical_min;
+    uint16_t usage_min;
+    uint16_t usage_max;
+  } hid_consumer_array_t;
+
+  // 消费类输入报告布局(第一个Consumer Control Application Collection)
+  // 提取计划在扫描时直接编译,配置后即可用于热路径
+  typedef struct
+  {
+    uint8_t report_id;  // Report ID (0 means no report ID)
+    uint8_t min_length; // 数据包最小字节数(含report_id字节)
+    uint8_t bit_count;
+    uint8_t array_count;
+    hid_consumer_bit_t bits[HID_CONSUMER_MAX_BITS];
+    hid_consumer_array_t arrays[HID_CONSUMER_MAX_ARRAYS];
+  } hid_consumer_layout_t;
+
+  /**
+   * @brief Scan descriptor for a consumer-control input report layout
+   *
+   * 记录第一个Consumer Control Application Collection里输入报告的
+   * usage位图字段(逐位)和usage数组字段,并编译好提取计划,
+   * 供消费类转发管线把任意16位usage直接翻译成BLE报告
+   *
+   * @param descriptor Pointer to HID report descriptor
+   * @param descriptor_size Size of descriptor in bytes
+   * @param out Output layout
+   * @return 0 if a consumer input report was found, -1 otherwise
+   */
+  int parse_hid_consumer_layout(const void *descriptor, size_t descriptor_size,
+                                hid_consumer_layout_t *out);
+
+// Resolution Multiplier feature最多记录的字段数
+// (典型描述符为wheel一个,带倾斜滚轮的为wheel+pan两个)
+#define HID_RES_MULT_MAX_FIELDS 2
+
+  // Resolution Multiplier feature报告信息（高分辨率滚轮）
+  // 枚举阶段SET_FEATURE写入logical_max启用高分辨率模式,
+  // 之后wheel/pan每detent上报multiplier个计数
+  typedef struct
+  {
+    uint8_t report_id;         // Feature报告ID (0表示描述符中没有multiplier)
+    uint8_t field_count;       // multiplier字段数
+    uint32_t report_size_bits; // 该feature报告的总位数(不含report_id字节)
+    uint32_t bit_offsets[HID_RES_MULT_MAX_FIELDS]; // 各字段位偏移
+    uint32_t sizes[HID_RES_MULT_MAX_FIELDS];       // 各字段位宽
+    int32_t logical_max;       // 写入该值启用最高分辨率
+    int32_t effective;         // 启用后的实际倍率(physical_max,未声明时取logical_max)
+  } hid_res_multiplier_t;
+
+  /**
+   * @brief Scan descriptor for a Resolution Multiplier feature report
+   *
+   * 独立于输入布局解析的轻量扫描: 只跟踪feature报告里的
+   * Resolution Multiplier(Generic Desktop 0x48)字段,
+   * 供枚举阶段构建SET_FEATURE报告启用高分辨率滚轮
+   *
+   * @param descriptor Pointer to HID report descriptor
+   * @param descriptor_size Size of descriptor in bytes
+   * @param out Output multiplier info
+   * @return 0 if a multiplier feature was found, -1 otherwise
+   */
+  int parse_hid_resolution_multiplier(const void *descriptor, size_t descriptor_size,
+                                      hid_res_multiplier_t *out);
+
   /**
    * @brief Parse HID report descriptor and extract multiple mouse layouts
    *
@@ -31,7 +31,11 @@
 #define HID_MAX_APPS 1
 
 // Number of HID reports defined in the service
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+#define HID_NUM_REPORTS 10
+#else
 #define HID_NUM_REPORTS 9
+#endif
 
 // HID Report IDs for the service
 // 注意：新的 Report Map 中 Report ID 已重新分配：
@@ -39,10 +43,13 @@
 // Report ID 2: Consumer Control
 // Report ID 3: Mouse
 // Report ID 4: Gamepad (可选，通过 CONFIG_MODULE_USEJOYSTICK 控制)
+// Report ID 6: NKRO Keyboard (可选，通过 CONFIG_NKRO_KEYBOARD 控制)
 #define HID_RPT_ID_KEY_IN 1   // Keyboard input report ID
 #define HID_RPT_ID_CC_IN 2    // Consumer Control input report ID
 #define HID_RPT_ID_MOUSE_IN 3 // Mouse input report ID
+#define HID_RPT_ID_NKRO_IN 6  // NKRO keyboard bitmap input report ID
 #if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+#define HID_RPT_ID_GAMEPAD_IN 4 // Gamepad input report ID
 #define HID_RPT_ID_VENDOR_OUT 5 // Vendor output report ID (Gamepad 使用 4，Vendor 使用 5)
 #else
 #define HID_RPT_ID_VENDOR_OUT 4 // Vendor output report ID (如果没有 Gamepad，Vendor 使用 4)
@@ -151,6 +158,22 @@ enum
     HIDD_LE_IDX_REPORT_CC_IN_CCC,
     HIDD_LE_IDX_REPORT_CC_IN_REP_REF,
 
+#if defined(CONFIG_NKRO_KEYBOARD) && CONFIG_NKRO_KEYBOARD
+    // Report NKRO keyboard input
+    HIDD_LE_IDX_REPORT_NKRO_IN_CHAR,
+    HIDD_LE_IDX_REPORT_NKRO_IN_VAL,
+    HIDD_LE_IDX_REPORT_NKRO_IN_CCC,
+    HIDD_LE_IDX_REPORT_NKRO_IN_REP_REF,
+#endif
+
+#if defined(CONFIG_MODULE_USEJOYSTICK) && CONFIG_MODULE_USEJOYSTICK
+    // Report Gamepad input
+    HIDD_LE_IDX_REPORT_GAMEPAD_IN_CHAR,
+    HIDD_LE_IDX_REPORT_GAMEPAD_IN_VAL,
+    HIDD_LE_IDX_REPORT_GAMEPAD_IN_CCC,
+    HIDD_LE_IDX_REPORT_GAMEPAD_IN_REP_REF,
+#endif
+
     // Boot Keyboard Input Report
     HIDD_LE_IDX_BOOT_KB_IN_REPORT_CHAR,
     HIDD_LE_IDX_BOOT_KB_IN_REPORT_VAL,
@@ -0,0 +1,34 @@
+/*
+ * 输入热路径段放置宏 - 头文件
+ *
+ * 核心思想:
+ * - NVS提交(配对落盘)或未来OTA写flash期间cache被关闭,
+ *   任何从flash取指的代码都会停顿——输入路径上表现为
+ *   偶发的数毫秒级冻结
+ * - CONFIG_INPUT_HOT_PATH_IRAM启用时把输入热路径函数放进IRAM、
+ *   其常量表放进DRAM,输入延迟不再取决于NVS在做什么
+ * - 关闭时两个宏展开为空,放置与默认链接一致(省IRAM)
+ */
+
+#ifndef HOT_PATH_H__
+#define HOT_PATH_H__
+
+#include "sdkconfig.h"
+
+#if defined(CONFIG_INPUT_HOT_PATH_IRAM) && CONFIG_INPUT_HOT_PATH_IRAM
+
+#include "esp_attr.h"
+
+// 热路径函数: 常驻IRAM,flash cache关闭期间照常执行
+#define HOT_PATH_IRAM_ATTR IRAM_ATTR
+// 热路径常量表: 常驻DRAM(默认.rodata在flash上,取数同样会停顿)
+#define HOT_PATH_DRAM_ATTR DRAM_ATTR
+
+#else /* !CONFIG_INPUT_HOT_PATH_IRAM */
+
+#define HOT_PATH_IRAM_ATTR
+#define HOT_PATH_DRAM_ATTR
+
+#endif /* CONFIG_INPUT_HOT_PATH_IRAM */
+
+#endif /* HOT_PATH_H__ */
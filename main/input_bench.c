@@ -0,0 +1,232 @@
+/*
+ * On-target Input Benchmark - 实现文件
+ *
+ * 运行流程: 等BLE连接 -> 静置让参数协商收敛 -> esp_timer按配置
+ * 频率注入合成事件 -> 到时停止 -> 打印计数器差值和延迟直方图。
+ *
+ * 注意: 注入走和USB解析路径相同的生产者入口(mouse_accumulator_add/
+ * keyboard_queue_push/consumer_pipeline_push),这些入口是单生产者
+ * 约定——基准运行期间不要插真实输入设备。
+ */
+
+#include "input_bench.h"
+#include "sdkconfig.h"
+
+#if defined(CONFIG_INPUT_BENCH) && CONFIG_INPUT_BENCH
+
+#include "consumer_pipeline.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hid_dev.h"
+#include "keyboard_queue.h"
+#include "mouse_accumulator.h"
+#include <string.h>
+
+static const char *TAG = "INPUT_BENCH";
+
+// 连接后静置时间(秒): 让连接参数/PHY协商收敛,数据才可比
+#define BENCH_SETTLE_S 5
+
+// burst模式的占空比: 每100拍的前10拍注入,每拍4个事件
+#define BENCH_BURST_CYCLE 100
+#define BENCH_BURST_ACTIVE 10
+#define BENCH_BURST_EVENTS 4
+
+static esp_timer_handle_t s_inject_timer = NULL;
+static uint32_t s_tick = 0;
+static uint32_t s_injected_mouse = 0;
+static uint32_t s_injected_kb = 0;
+static uint32_t s_injected_cc = 0;
+
+// 运行前的计数器快照(结束后取差值)
+static uint32_t s_snap_overflow, s_snap_pushed, s_snap_popped, s_snap_sent, s_snap_failures;
+static uint32_t s_snap_kb_sent, s_snap_cc_sent;
+
+/* =================================================================================================
+   事件注入
+   ================================================================================================= */
+
+// 注入一个鼠标移动事件(小幅画圈,避免指针顶到屏幕边缘)
+static void inject_mouse(void)
+{
+  static const int8_t dx_seq[] = {1, 1, 0, -1, -1, -1, 0, 1};
+  static const int8_t dy_seq[] = {0, 1, 1, 1, 0, -1, -1, -1};
+  uint32_t phase = s_tick & 7;
+  mouse_accumulator_add(dx_seq[phase], dy_seq[phase], 0, 0, 0);
+  s_injected_mouse++;
+}
+
+// 注入一对键盘按下/释放(交替调用)
+static void inject_keyboard(void)
+{
+  uint8_t report[KEYBOARD_QUEUE_RPT_LEN] = {0};
+  if ((s_injected_kb & 1) == 0)
+  {
+    report[2] = HID_KEY_A;
+  }
+  keyboard_queue_push(report);
+  s_injected_kb++;
+}
+
+// 注入一对消费类按下/释放(交替调用,音量加usage LE16直通)
+static void inject_consumer(void)
+{
+  uint8_t report[2] = {0, 0};
+  if ((s_injected_cc & 1) == 0)
+  {
+    report[0] = HID_CONSUMER_VOLUME_UP;
+  }
+  consumer_pipeline_push(report, sizeof(report), false);
+  s_injected_cc++;
+}
+
+/**
+ * @brief 注入定时器回调(esp_timer任务,周期=1e6/CONFIG_INPUT_BENCH_RATE_HZ)
+ */
+static void inject_timer_callback(void *arg)
+{
+  s_tick++;
+
+#if defined(CONFIG_INPUT_BENCH_PATTERN_BURST) && CONFIG_INPUT_BENCH_PATTERN_BURST
+  // 突发模式: 短时间高密度事件,考验ring的溢出合并路径
+  if ((s_tick % BENCH_BURST_CYCLE) < BENCH_BURST_ACTIVE)
+  {
+    for (int i = 0; i < BENCH_BURST_EVENTS; i++)
+    {
+      inject_mouse();
+    }
+  }
+#elif defined(CONFIG_INPUT_BENCH_PATTERN_MIXED) && CONFIG_INPUT_BENCH_PATTERN_MIXED
+  // 混合模式: 持续鼠标流 + 周期键盘/消费类事件,贴近真实使用
+  inject_mouse();
+  if ((s_tick % 50) == 0)
+  {
+    inject_keyboard();
+  }
+  if ((s_tick % 100) == 0)
+  {
+    inject_consumer();
+  }
+#else
+  // 恒定模式: 每拍一个移动事件(默认1000Hz,等价高回报率鼠标)
+  inject_mouse();
+#endif
+}
+
+/* =================================================================================================
+   运行控制
+   ================================================================================================= */
+
+static void snapshot_counters(void)
+{
+  mouse_accumulator_get_stats(NULL, &s_snap_overflow, &s_snap_pushed,
+                              &s_snap_popped, &s_snap_sent, &s_snap_failures);
+  keyboard_queue_get_stats(NULL, NULL, &s_snap_kb_sent, NULL, NULL);
+  consumer_pipeline_get_stats(NULL, NULL, &s_snap_cc_sent, NULL, NULL);
+}
+
+static void print_summary(uint32_t elapsed_ms)
+{
+  uint32_t overflow, pushed, popped, sent, failures;
+  uint32_t kb_sent, cc_sent;
+  mouse_accumulator_get_stats(NULL, &overflow, &pushed, &popped, &sent, &failures);
+  keyboard_queue_get_stats(NULL, NULL, &kb_sent, NULL, NULL);
+  consumer_pipeline_get_stats(NULL, NULL, &cc_sent, NULL, NULL);
+
+  uint32_t d_pushed = pushed - s_snap_pushed;
+  uint32_t d_sent = sent - s_snap_sent;
+
+  ESP_LOGI(TAG, "==== 基准汇总 (%lu ms) ====", (unsigned long)elapsed_ms);
+  ESP_LOGI(TAG, "注入: 鼠标%lu, 键盘%lu, 消费类%lu",
+           (unsigned long)s_injected_mouse, (unsigned long)s_injected_kb,
+           (unsigned long)s_injected_cc);
+  ESP_LOGI(TAG, "鼠标: 推入%lu, 弹出%lu, notify %lu (%.1f/s), 失败%lu, 溢出合并%lu",
+           (unsigned long)d_pushed, (unsigned long)(popped - s_snap_popped),
+           (unsigned long)d_sent, (float)d_sent * 1000.0f / (float)elapsed_ms,
+           (unsigned long)(failures - s_snap_failures),
+           (unsigned long)(overflow - s_snap_overflow));
+  if (s_injected_mouse != d_pushed)
+  {
+    ESP_LOGW(TAG, "注入数与推入数不一致(%lu != %lu),检查是否有真实设备在产生输入",
+             (unsigned long)s_injected_mouse, (unsigned long)d_pushed);
+  }
+  ESP_LOGI(TAG, "键盘notify: %lu, 消费类notify: %lu",
+           (unsigned long)(kb_sent - s_snap_kb_sent),
+           (unsigned long)(cc_sent - s_snap_cc_sent));
+  // 端到端延迟直方图(事件入ring到notify返回)
+  mouse_accumulator_log_latency();
+  ESP_LOGI(TAG, "==== 基准结束 ====");
+}
+
+/**
+ * @brief 基准任务: 一次性运行后自删除
+ */
+static void input_bench_task(void *arg)
+{
+  ESP_LOGI(TAG, "基准模式启用: 等待BLE连接...");
+  while (!mouse_accumulator_is_ble_connected())
+  {
+    vTaskDelay(pdMS_TO_TICKS(500));
+  }
+
+  ESP_LOGI(TAG, "BLE已连接,静置%d秒等参数协商收敛", BENCH_SETTLE_S);
+  vTaskDelay(pdMS_TO_TICKS(BENCH_SETTLE_S * 1000));
+
+  snapshot_counters();
+
+  uint64_t period_us = 1000000ULL / CONFIG_INPUT_BENCH_RATE_HZ;
+  ESP_LOGI(TAG, "开始注入: %dHz x %d秒", CONFIG_INPUT_BENCH_RATE_HZ,
+           CONFIG_INPUT_BENCH_DURATION_S);
+  uint64_t t_start = esp_timer_get_time();
+  esp_timer_start_periodic(s_inject_timer, period_us);
+
+  vTaskDelay(pdMS_TO_TICKS(CONFIG_INPUT_BENCH_DURATION_S * 1000));
+
+  esp_timer_stop(s_inject_timer);
+  // 留一个发送窗口把尾部事件排空
+  vTaskDelay(pdMS_TO_TICKS(200));
+
+  print_summary((uint32_t)((esp_timer_get_time() - t_start) / 1000) - 200);
+  vTaskDelete(NULL);
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+esp_err_t input_bench_start(void)
+{
+  const esp_timer_create_args_t timer_args = {
+      .callback = &inject_timer_callback,
+      .arg = NULL,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "bench_inject"};
+
+  esp_err_t ret = esp_timer_create(&timer_args, &s_inject_timer);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGE(TAG, "创建注入定时器失败: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  // 优先级低于发送/解析任务: 基准控制流不挤占被测路径
+  BaseType_t created = xTaskCreatePinnedToCore(input_bench_task, "input_bench",
+                                               4096, NULL, 1, NULL, 0);
+  if (created != pdPASS)
+  {
+    ESP_LOGE(TAG, "创建基准任务失败");
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+#else /* !CONFIG_INPUT_BENCH */
+
+esp_err_t input_bench_start(void)
+{
+  return ESP_OK;
+}
+
+#endif /* CONFIG_INPUT_BENCH */
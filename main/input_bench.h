@@ -0,0 +1,38 @@
+/*
+ * On-target Input Benchmark - 头文件
+ *
+ * 核心思想:
+ * - 不插真实设备也能复现固件输入路径的吞吐/延迟表现:
+ *   按配置的模式在片上生成合成事件流,直接注入各发送管线
+ * - 累加器已有的计数器和延迟直方图记录整个运行,
+ *   结束后打印前后差值汇总,跑在每次刷机前就是回归基线
+ * - 由CONFIG_INPUT_BENCH门控,关闭时整个模块编译为空;
+ *   与host_test/parser_bench配对构成端到端性能回归套件
+ */
+
+#ifndef INPUT_BENCH_H__
+#define INPUT_BENCH_H__
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /**
+   * @brief 启动基准任务(app_main初始化末尾调用)
+   *
+   * 任务等待BLE连接建立后静置数秒,再按CONFIG_INPUT_BENCH_PATTERN
+   * 注入CONFIG_INPUT_BENCH_DURATION_S秒的事件流并打印汇总。
+   * CONFIG_INPUT_BENCH关闭时为no-op
+   *
+   * @return ESP_OK 成功(含no-op),其他值表示任务创建失败
+   */
+  esp_err_t input_bench_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INPUT_BENCH_H__ */
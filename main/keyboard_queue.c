@@ -0,0 +1,202 @@
+/*
+ * Keyboard Report Transmit Queue - Implementation File
+ *
+ * 核心逻辑:
+ * - USB侧: push报告到无锁SPSC队列(producer)
+ * - BLE侧: ble_tx任务节拍驱动,依次notify待发报告(consumer)
+ * - 合并策略: 相同状态去重;队列满时溢出槽只保留最新状态
+ */
+
+#include "keyboard_queue.h"
+#include "esp_log.h"
+#include "hid_dev.h"
+#include "hot_path.h"
+#include "hid_host_example.h"
+#include "mouse_accumulator.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "KB_QUEUE";
+
+// 队列条目: 一条完整的键盘输入报告
+typedef struct
+{
+  uint8_t report[KEYBOARD_QUEUE_RPT_LEN];
+} kb_entry_t;
+
+// 无锁SPSC队列(与mouse_accumulator的ring同样的head/tail设计)
+typedef struct
+{
+  kb_entry_t entries[KEYBOARD_QUEUE_CAPACITY];
+  _Atomic uint32_t head; // 写入索引(仅生产者递增)
+  _Atomic uint32_t tail; // 读取索引(仅消费者递增)
+} kb_queue_t;
+
+static kb_queue_t g_queue = {
+    .head = 0,
+    .tail = 0};
+
+// 生产者端状态(仅USB回调访问)
+// 溢出槽: 队列满时暂存最新报告,腾出空间后优先补发
+static kb_entry_t s_overflow_entry;
+static bool s_overflow_valid = false;
+static uint8_t s_last_pushed[KEYBOARD_QUEUE_RPT_LEN]; // 最近入队的状态(去重用)
+static bool s_last_pushed_valid = false;
+
+// 统计(各自只有单一写者)
+static uint32_t s_total_pushed = 0;
+static uint32_t s_total_sent = 0;
+static uint32_t s_total_coalesced = 0;
+static uint32_t s_total_failures = 0;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+static uint32_t HOT_PATH_IRAM_ATTR queue_count(void)
+{
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  return head - tail;
+}
+
+// 生产者: 尝试写入一条报告,满时返回false
+static bool HOT_PATH_IRAM_ATTR queue_push_raw(const kb_entry_t *entry)
+{
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_acquire);
+
+  if (head - tail >= KEYBOARD_QUEUE_CAPACITY)
+  {
+    return false;
+  }
+
+  g_queue.entries[head & KEYBOARD_QUEUE_MASK] = *entry;
+  atomic_store_explicit(&g_queue.head, head + 1, memory_order_release);
+  return true;
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+void keyboard_queue_init(void)
+{
+  keyboard_queue_clear();
+  ESP_LOGI(TAG, "键盘发送队列初始化成功(容量: %d条报告)", KEYBOARD_QUEUE_CAPACITY);
+}
+
+void keyboard_queue_clear(void)
+{
+  // 消费者方式排空: tail推进到head(保持SPSC约束,不重置索引)
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  atomic_store_explicit(&g_queue.tail, head, memory_order_release);
+  s_overflow_valid = false;
+  s_last_pushed_valid = false;
+}
+
+void HOT_PATH_IRAM_ATTR keyboard_queue_push(const uint8_t *report)
+{
+  if (report == NULL)
+  {
+    return;
+  }
+
+  // 去重: 与最近入队的状态完全相同的报告没有信息量,直接丢弃
+  // (按下/释放必然产生不同的状态,过渡不会被去重吃掉)
+  if (s_last_pushed_valid &&
+      memcmp(s_last_pushed, report, KEYBOARD_QUEUE_RPT_LEN) == 0 &&
+      !s_overflow_valid)
+  {
+    s_total_coalesced++;
+    return;
+  }
+
+  kb_entry_t entry;
+  memcpy(entry.report, report, KEYBOARD_QUEUE_RPT_LEN);
+
+  // 先补发之前因队列满暂存的溢出报告,保持顺序
+  if (s_overflow_valid)
+  {
+    if (queue_push_raw(&s_overflow_entry))
+    {
+      s_overflow_valid = false;
+      s_total_pushed++;
+    }
+  }
+
+  if (!s_overflow_valid && queue_push_raw(&entry))
+  {
+    s_total_pushed++;
+  }
+  else
+  {
+    // 队列仍满: 溢出槽只保留最新状态(中间状态被取代,最终状态不丢)
+    if (s_overflow_valid)
+    {
+      s_total_coalesced++;
+    }
+    s_overflow_entry = entry;
+    s_overflow_valid = true;
+  }
+
+  memcpy(s_last_pushed, report, KEYBOARD_QUEUE_RPT_LEN);
+  s_last_pushed_valid = true;
+
+  // 立即唤醒发送任务,不等下一个定时器节拍(降低按键延迟)
+  mouse_accumulator_request_send();
+}
+
+void HOT_PATH_IRAM_ATTR keyboard_queue_try_send(void)
+{
+  if (!mouse_accumulator_is_ble_connected())
+  {
+    return;
+  }
+
+  // 拥塞流控: 控制器队列满时报告留在队列中,拥塞解除后再发
+  if (hid_dev_is_congested())
+  {
+    return;
+  }
+
+  // 依次发送所有待发报告;失败时停止,剩余报告下个节拍重试
+  while (queue_count() > 0)
+  {
+    uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+    kb_entry_t *entry = &g_queue.entries[tail & KEYBOARD_QUEUE_MASK];
+
+    esp_err_t ret = keyboard_queue_send_ble_report(entry->report, KEYBOARD_QUEUE_RPT_LEN);
+    if (ret != ESP_OK)
+    {
+      s_total_failures++;
+      // 通知未启用是正常状态,不打日志
+      if (ret != ESP_ERR_INVALID_STATE)
+      {
+        ESP_LOGW(TAG, "键盘报告发送失败(%s),保留队列下次重试", esp_err_to_name(ret));
+      }
+      return;
+    }
+
+    atomic_store_explicit(&g_queue.tail, tail + 1, memory_order_release);
+    s_total_sent++;
+  }
+}
+
+void keyboard_queue_get_stats(uint32_t *pending,
+                              uint32_t *total_pushed,
+                              uint32_t *total_sent,
+                              uint32_t *total_coalesced,
+                              uint32_t *total_failures)
+{
+  if (pending)
+    *pending = queue_count() + (s_overflow_valid ? 1 : 0);
+  if (total_pushed)
+    *total_pushed = s_total_pushed;
+  if (total_sent)
+    *total_sent = s_total_sent;
+  if (total_coalesced)
+    *total_coalesced = s_total_coalesced;
+  if (total_failures)
+    *total_failures = s_total_failures;
+}
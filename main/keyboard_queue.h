@@ -0,0 +1,74 @@
+/*
+ * Keyboard Report Transmit Queue - Header File
+ *
+ * 核心思想:
+ * - USB键盘回调只把8字节报告push进无锁SPSC队列,立即返回
+ * - BLE发送由ble_tx任务的节拍驱动,拥塞的BLE链路不再反压USB处理
+ * - 合并被取代的报告: 连续相同状态去重,溢出时保留最新状态
+ *   (按下/释放的过渡只要队列未溢出就逐条保留)
+ */
+
+#ifndef KEYBOARD_QUEUE_H__
+#define KEYBOARD_QUEUE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 队列容量(必须是2的幂)
+// 键盘报告速率远低于鼠标,16条足以覆盖BLE短暂拥塞时的快速输入
+#define KEYBOARD_QUEUE_CAPACITY 16
+#define KEYBOARD_QUEUE_MASK (KEYBOARD_QUEUE_CAPACITY - 1)
+
+// 键盘报告长度(Boot Protocol: 修饰键1 + 保留1 + 按键6)
+#define KEYBOARD_QUEUE_RPT_LEN 8
+
+  /**
+   * @brief 初始化键盘发送队列
+   *
+   * 只重置内部状态,消费端由mouse_accumulator的ble_tx任务节拍驱动
+   */
+  void keyboard_queue_init(void);
+
+  /**
+   * @brief 清空队列(断线重连等场景)
+   */
+  void keyboard_queue_clear(void);
+
+  /**
+   * @brief USB键盘报告入队(Producer,USB回调上下文调用)
+   *
+   * 与最新待发报告完全相同的状态会被去重;
+   * 队列满时新报告暂存到溢出槽,只保留最新状态(中间状态被取代)
+   *
+   * @param report 8字节键盘报告(修饰键+保留+6按键)
+   */
+  void keyboard_queue_push(const uint8_t *report);
+
+  /**
+   * @brief 取出待发报告并通过BLE发送(Consumer,ble_tx任务调用)
+   *
+   * 每个节拍把队列中所有待发报告依次notify;
+   * 发送失败时停止并保留剩余报告,下个节拍重试
+   */
+  void keyboard_queue_try_send(void);
+
+  /**
+   * @brief 获取队列统计信息(调试用)
+   */
+  void keyboard_queue_get_stats(uint32_t *pending,
+                                uint32_t *total_pushed,
+                                uint32_t *total_sent,
+                                uint32_t *total_coalesced,
+                                uint32_t *total_failures);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KEYBOARD_QUEUE_H__ */
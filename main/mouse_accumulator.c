@@ -9,11 +9,22 @@
  */
 
 #include "mouse_accumulator.h"
+#include "conn_params.h"
+#include "consumer_pipeline.h"
+#include "deferred_log.h"
 #include "esp_log.h"
+#include "gamepad_resampler.h"
 #include "hid_dev.h"
 #include "hidd_le_prf_int.h"
 #include "hid_host_example.h"
+#include "hot_path.h"
+#include "keyboard_queue.h"
+#include "nkro_keyboard.h"
+#include "perf_probe.h"
+#include "power_mgmt.h"
+#include "freertos/task.h"
 #include <string.h>
+#include <stdio.h>
 
 /* =================================================================================================
    内部变量
@@ -26,13 +37,12 @@ static mouse_motion_accumulator_t g_acc = {
     .ring = {
         .head = 0,
         .tail = 0,
-        .count = 0,
-        .overflow_count = 0,
-        .spinlock = portMUX_INITIALIZER_UNLOCKED},
+        .overflow_count = 0},
     .t_last_send_us = 0,
     .residual_dx = 0,
     .residual_dy = 0,
     .residual_wheel = 0,
+    .residual_pan = 0,
     .last_known_buttons = 0,
     .last_usb_buttons = 0,
     .total_events_pushed = 0,
@@ -43,9 +53,27 @@ static mouse_motion_accumulator_t g_acc = {
 // BLE发送定时器句柄
 static esp_timer_handle_t s_send_timer = NULL;
 
+// BLE发送任务句柄(固定到core 1,由定时器节拍通过任务通知唤醒)
+static TaskHandle_t s_tx_task = NULL;
+
 // 当前BLE发送间隔(微秒),动态更新
 static uint32_t s_current_send_interval_us = BLE_SEND_INTERVAL_US_DEFAULT;
 
+// 空闲门控: 定时器是否处于active状态(生产者/消费者跨核访问,seq_cst)
+static atomic_bool s_timer_active = false;
+
+// 连续空窗口计数(仅消费者ble_tx任务访问)
+static uint32_t s_empty_windows = 0;
+
+// 端到端延迟直方图(仅消费者写入)
+static latency_histogram_t s_latency = {
+    .min_us = UINT32_MAX};
+
+// 滚轮分辨率倍率(高分辨率滚轮): 积分以hi-res计数进行,
+// 发送时除以此值发整detent,余数留在残差里
+// 枚举任务写/消费者读,单字节对齐访问天然原子
+static volatile uint8_t s_wheel_divisor = 1;
+
 /* =================================================================================================
    内部辅助函数
    ================================================================================================= */
@@ -71,118 +99,228 @@ static inline uint64_t get_time_us(void)
 }
 
 /**
- * @brief Ring buffer push (Producer端,线程安全)
+ * @brief Ring buffer push (仅生产者调用,无锁)
  *
- * @return true 成功, false 失败(满)
+ * 先写入事件数据,再以release顺序发布head,
+ * 保证消费者以acquire读到新head时事件内容已可见
+ *
+ * @return true 成功, false 失败(满,事件被丢弃并计入overflow_count)
  */
-static bool ring_push(mouse_event_t *event)
+static bool HOT_PATH_IRAM_ATTR ring_push(mouse_event_t *event)
 {
-  bool success = false;
+  uint32_t head = atomic_load_explicit(&g_acc.ring.head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&g_acc.ring.tail, memory_order_acquire);
 
-  portENTER_CRITICAL(&g_acc.ring.spinlock);
+  if (head - tail >= RING_BUFFER_CAPACITY)
   {
-    if (g_acc.ring.count < RING_BUFFER_CAPACITY)
-    {
-      // 未满,直接写入
-      uint32_t write_idx = g_acc.ring.head & RING_BUFFER_MASK;
-      g_acc.ring.events[write_idx] = *event;
-      g_acc.ring.head++;
-      g_acc.ring.count++;
-      g_acc.total_events_pushed++;
-      success = true;
-    }
-    else
-    {
-      // 满了,丢弃最老的事件(保证新数据不丢)
-      // 推荐策略: 丢最老,防止当前甩动丢失
-      uint32_t write_idx = g_acc.ring.head & RING_BUFFER_MASK;
-      g_acc.ring.events[write_idx] = *event;
-      g_acc.ring.head++;
-      g_acc.ring.tail++; // 同时前移tail,覆盖最老
-      g_acc.ring.overflow_count++;
-      g_acc.total_events_pushed++;
-      success = true; // 仍然算成功(已写入)
-
-      // 注意: count保持不变(仍然是CAPACITY)
-    }
+    // 满了: 生产者不能动tail(SPSC约束),由调用方合并进溢出累加器
+    // 消费者积分发送后会腾出空间
+    g_acc.ring.overflow_count++;
+    return false;
   }
-  portEXIT_CRITICAL(&g_acc.ring.spinlock);
 
-  return success;
+  g_acc.ring.events[head & RING_BUFFER_MASK] = *event;
+  atomic_store_explicit(&g_acc.ring.head, head + 1, memory_order_release);
+  g_acc.total_events_pushed++;
+  return true;
 }
 
 /**
- * @brief Ring buffer peek (Consumer端预览,不修改tail)
+ * @brief Ring buffer peek (仅消费者调用,不修改tail)
  *
  * 用于两阶段提交的第一阶段
+ * idx必须小于ring_get_count()返回的快照值:
+ * 这些条目位于[tail, head)区间内,生产者不会再触碰
  *
  * @param idx 要peek的索引(相对tail的偏移)
  * @param out_event 输出事件指针
  * @return true 成功, false 越界
  */
-static bool ring_peek(uint32_t idx, mouse_event_t *out_event)
+static bool HOT_PATH_IRAM_ATTR ring_peek(uint32_t idx, mouse_event_t *out_event)
 {
-  bool success = false;
+  uint32_t tail = atomic_load_explicit(&g_acc.ring.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_acc.ring.head, memory_order_acquire);
 
-  portENTER_CRITICAL(&g_acc.ring.spinlock);
+  if (idx >= head - tail)
   {
-    if (idx < g_acc.ring.count)
-    {
-      uint32_t read_idx = (g_acc.ring.tail + idx) & RING_BUFFER_MASK;
-      *out_event = g_acc.ring.events[read_idx];
-      success = true;
-    }
+    return false;
   }
-  portEXIT_CRITICAL(&g_acc.ring.spinlock);
 
-  return success;
+  *out_event = g_acc.ring.events[(tail + idx) & RING_BUFFER_MASK];
+  return true;
 }
 
 /**
- * @brief Ring buffer批量pop (Consumer端,两阶段提交的第二阶段)
+ * @brief Ring buffer批量pop (仅消费者调用,两阶段提交的第二阶段)
  *
  * @param num_to_pop 要弹出的事件数量
  */
-static void ring_pop_batch(uint32_t num_to_pop)
+static void HOT_PATH_IRAM_ATTR ring_pop_batch(uint32_t num_to_pop)
 {
-  portENTER_CRITICAL(&g_acc.ring.spinlock);
+  uint32_t tail = atomic_load_explicit(&g_acc.ring.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_acc.ring.head, memory_order_acquire);
+
+  if (num_to_pop > head - tail)
   {
-    if (num_to_pop > g_acc.ring.count)
-    {
-      num_to_pop = g_acc.ring.count;
-    }
+    num_to_pop = head - tail;
+  }
+
+  atomic_store_explicit(&g_acc.ring.tail, tail + num_to_pop, memory_order_release);
+  g_acc.total_events_popped += num_to_pop;
+}
 
-    g_acc.ring.tail += num_to_pop;
-    g_acc.ring.count -= num_to_pop;
-    g_acc.total_events_popped += num_to_pop;
+/**
+ * @brief 获取ring buffer当前事件数快照
+ */
+static uint32_t HOT_PATH_IRAM_ATTR ring_get_count(void)
+{
+  uint32_t tail = atomic_load_explicit(&g_acc.ring.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_acc.ring.head, memory_order_acquire);
+  return head - tail;
+}
+
+/**
+ * @brief 记录一个端到端延迟样本(仅消费者调用)
+ */
+static void HOT_PATH_IRAM_ATTR latency_record(uint32_t delta_us)
+{
+  uint32_t bucket = delta_us / LATENCY_HIST_BUCKET_US;
+  if (bucket >= LATENCY_HIST_BUCKETS)
+  {
+    bucket = LATENCY_HIST_BUCKETS - 1;
+  }
+  s_latency.buckets[bucket]++;
+  s_latency.count++;
+  s_latency.sum_us += delta_us;
+  if (delta_us < s_latency.min_us)
+  {
+    s_latency.min_us = delta_us;
+  }
+  if (delta_us > s_latency.max_us)
+  {
+    s_latency.max_us = delta_us;
   }
-  portEXIT_CRITICAL(&g_acc.ring.spinlock);
 }
 
 /**
- * @brief 获取ring buffer当前事件数(线程安全)
+ * @brief 确保周期定时器处于active状态,必要时重启并立即触发一次发送
+ *
+ * 生产者在push首条新事件时调用: idle->active的迁移立即发送,
+ * 最多可省掉一个完整的7.5ms节拍的首包延迟
+ * exchange保证多个调用方竞争时只有一个真正执行restart
  */
-static uint32_t ring_get_count(void)
+static void ensure_timer_active(void)
 {
-  uint32_t count;
-  portENTER_CRITICAL(&g_acc.ring.spinlock);
+  if (s_send_timer == NULL || s_tx_task == NULL)
   {
-    count = g_acc.ring.count;
+    return;
+  }
+  if (!atomic_exchange(&s_timer_active, true))
+  {
+    esp_timer_start_periodic(s_send_timer, s_current_send_interval_us);
+    xTaskNotifyGive(s_tx_task);
+    // 通知连接参数引擎: 空闲后的第一条输入,必要时切回性能参数
+    conn_params_notify_activity();
+    // 通知电源管理: 重新持锁回全速(省电模式下才有动作)
+    power_mgmt_notify_activity();
+    ESP_LOGD(TAG, "idle -> active: 定时器重启,立即发送");
   }
-  portEXIT_CRITICAL(&g_acc.ring.spinlock);
-  return count;
+}
+
+/**
+ * @brief 消费者侧: 进入idle,停止周期定时器(仅ble_tx任务调用)
+ *
+ * 停表后重查ring,封掉生产者"刚push完但还看到active"的丢唤醒窗口:
+ * 两边对s_timer_active都是seq_cst,生产者要么看到false自己重启,
+ * 要么它的push对这里的重查可见
+ */
+static void enter_idle(void)
+{
+  if (s_send_timer == NULL)
+  {
+    return;
+  }
+  esp_timer_stop(s_send_timer);
+  atomic_store(&s_timer_active, false);
+  s_empty_windows = 0;
+  if (ring_get_count() > 0)
+  {
+    // 竞争窗口内有新事件进来,立刻回到active
+    ensure_timer_active();
+    return;
+  }
+  ESP_LOGD(TAG, "active -> idle: 连续%d个空窗口,定时器已停止", IDLE_EMPTY_WINDOWS_THRESHOLD);
 }
 
 /* =================================================================================================
    公共API实现
    ================================================================================================= */
 
+/**
+ * @brief BLE发送任务(固定到core 1)
+ *
+ * 阻塞等待定时器节拍的任务通知,被唤醒后执行时间窗积分和notify
+ * BLE栈的延迟只会阻塞本任务,不再影响esp_timer任务的其他客户端,
+ * 也不与core 0上的USB接收路径争抢CPU
+ */
+static void ble_tx_task(void *arg)
+{
+  while (true)
+  {
+    // 等待节拍通知(定时器tick或其他模块的立即唤醒)
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // 键盘优先: 按键的丢失/延迟比指针抖动更容易被感知
+    keyboard_queue_try_send();
+    nkro_keyboard_try_send();
+    consumer_pipeline_try_send();
+    mouse_accumulator_try_send();
+    gamepad_resampler_try_send();
+
+    // 空闲门控: 鼠标ring和键盘队列都排空后,连续N个空窗口就停掉周期
+    // 定时器,空闲时不再有每秒~133次的无效唤醒(也不挡light-sleep)
+    uint32_t kb_pending = 0;
+    uint32_t nkro_pending = 0;
+    uint32_t gp_pending = 0;
+    uint32_t cc_pending = 0;
+    keyboard_queue_get_stats(&kb_pending, NULL, NULL, NULL, NULL);
+    nkro_keyboard_get_stats(&nkro_pending, NULL, NULL, NULL, NULL);
+    gamepad_resampler_get_stats(&gp_pending, NULL, NULL, NULL, NULL);
+    consumer_pipeline_get_stats(&cc_pending, NULL, NULL, NULL, NULL);
+    if (ring_get_count() == 0 && kb_pending == 0 && nkro_pending == 0 &&
+        gp_pending == 0 && cc_pending == 0)
+    {
+      if (atomic_load(&s_timer_active) && ++s_empty_windows >= IDLE_EMPTY_WINDOWS_THRESHOLD)
+      {
+        enter_idle();
+      }
+    }
+    else
+    {
+      s_empty_windows = 0;
+    }
+  }
+}
+
 esp_err_t mouse_accumulator_init(void)
 {
   // 初始化时间基准
   g_acc.t_last_send_us = get_time_us();
 
-  // 创建BLE发送定时器
+  // 创建BLE发送任务(固定到core 1,与core 0的USB任务形成流水线)
+  BaseType_t task_created = xTaskCreatePinnedToCore(ble_tx_task,
+                                                    "ble_tx",
+                                                    BLE_TX_TASK_STACK_SIZE,
+                                                    NULL,
+                                                    BLE_TX_TASK_PRIORITY,
+                                                    &s_tx_task,
+                                                    BLE_TX_TASK_CORE);
+  if (task_created != pdTRUE)
+  {
+    ESP_LOGE(TAG, "创建BLE发送任务失败");
+    return ESP_ERR_NO_MEM;
+  }
+
+  // 创建BLE发送定时器(只负责轻量的任务通知,实际发送在ble_tx任务中完成)
   const esp_timer_create_args_t timer_args = {
       .callback = &mouse_accumulator_timer_callback,
       .arg = NULL,
@@ -193,6 +331,8 @@ esp_err_t mouse_accumulator_init(void)
   if (ret != ESP_OK)
   {
     ESP_LOGE(TAG, "创建BLE发送定时器失败: %s", esp_err_to_name(ret));
+    vTaskDelete(s_tx_task);
+    s_tx_task = NULL;
     return ret;
   }
 
@@ -203,45 +343,57 @@ esp_err_t mouse_accumulator_init(void)
     ESP_LOGE(TAG, "启动BLE发送定时器失败: %s", esp_err_to_name(ret));
     esp_timer_delete(s_send_timer);
     s_send_timer = NULL;
+    vTaskDelete(s_tx_task);
+    s_tx_task = NULL;
     return ret;
   }
+  atomic_store(&s_timer_active, true);
 
   ESP_LOGI(TAG, "鼠标累加器初始化成功(方案A: Ring Buffer)");
   ESP_LOGI(TAG, "  - Ring容量: %d条事件", RING_BUFFER_CAPACITY);
   ESP_LOGI(TAG, "  - 发送周期: %u us (约%.1f Hz)", (unsigned int)s_current_send_interval_us, 1000000.0 / s_current_send_interval_us);
+  ESP_LOGI(TAG, "  - 发送任务: core %d, 优先级 %d", BLE_TX_TASK_CORE, BLE_TX_TASK_PRIORITY);
+  ESP_LOGI(TAG, "  - 空闲门控: 连续%d个空窗口后停表", IDLE_EMPTY_WINDOWS_THRESHOLD);
 
   return ESP_OK;
 }
 
 void mouse_accumulator_clear(void)
 {
-  portENTER_CRITICAL(&g_acc.ring.spinlock);
-  {
-    g_acc.ring.head = 0;
-    g_acc.ring.tail = 0;
-    g_acc.ring.count = 0;
-    // overflow_count不清零,保留统计
+  // 消费者方式排空ring: 把tail推进到head(不重置索引,保持SPSC约束)
+  // 与生产者并发push的竞争窗口只会多留一条事件,断线场景下无害
+  uint32_t head = atomic_load_explicit(&g_acc.ring.head, memory_order_acquire);
+  atomic_store_explicit(&g_acc.ring.tail, head, memory_order_release);
+  // overflow_count不清零,保留统计
 
-    g_acc.t_last_send_us = get_time_us();
-    g_acc.residual_dx = 0;
-    g_acc.residual_dy = 0;
-    g_acc.residual_wheel = 0;
-    g_acc.last_known_buttons = 0;
-    g_acc.last_usb_buttons = 0;
-  }
-  portEXIT_CRITICAL(&g_acc.ring.spinlock);
+  g_acc.t_last_send_us = get_time_us();
+  g_acc.residual_dx = 0;
+  g_acc.residual_dy = 0;
+  g_acc.residual_wheel = 0;
+  g_acc.residual_pan = 0;
+  g_acc.ovf_dx = 0;
+  g_acc.ovf_dy = 0;
+  g_acc.ovf_wheel = 0;
+  g_acc.ovf_pan = 0;
+  g_acc.ovf_flags = 0;
+  g_acc.ovf_valid = false;
+  g_acc.last_known_buttons = 0;
+  g_acc.last_usb_buttons = 0;
 
   ESP_LOGI(TAG, "累加器已清空(Ring + 残差)");
 }
 
-void mouse_accumulator_add(int16_t dx, int16_t dy, int8_t wheel, uint8_t buttons)
+void HOT_PATH_IRAM_ATTR mouse_accumulator_add(int16_t dx, int16_t dy, int8_t wheel, int8_t pan, uint8_t buttons)
 {
+  PERF_PROBE_BEGIN();
+
   // 构建事件
   mouse_event_t event;
   event.t_us = get_time_us();
   event.dx = dx;
   event.dy = dy;
   event.wheel = wheel;
+  event.pan = pan;
   event.buttons = buttons & 0x1F; // 只保留低5位（支持侧键）
 
   // 检测按钮变化
@@ -249,24 +401,59 @@ void mouse_accumulator_add(int16_t dx, int16_t dy, int8_t wheel, uint8_t buttons
   if (g_acc.last_usb_buttons != buttons)
   {
     event.flags |= EVENT_FLAG_BUTTON_CHANGED;
-    // 调试：打印按钮变化事件
+    // 调试：记录按钮变化事件(热路径,走延迟日志)
     if (buttons & 0x18) // Button 4 或 Button 5
     {
-      ESP_LOGI(TAG, "[事件添加] 按钮变化: 0x%02X -> 0x%02X, flags=0x%02X (Button4=%d, Button5=%d)",
-               g_acc.last_usb_buttons, buttons, event.flags,
-               (buttons & 0x08) ? 1 : 0, (buttons & 0x10) ? 1 : 0);
+      DLOGI3(TAG, "[事件添加] 按钮变化: 0x%02X -> 0x%02X, flags=0x%02X",
+             g_acc.last_usb_buttons, buttons, event.flags);
     }
     g_acc.last_usb_buttons = buttons;
   }
 
+  // 溢出累加器有待折叠数据时,先合并进本次事件(带饱和,余量留下)
+  if (g_acc.ovf_valid)
+  {
+    int32_t sum_dx = (int32_t)event.dx + g_acc.ovf_dx;
+    int32_t sum_dy = (int32_t)event.dy + g_acc.ovf_dy;
+    int32_t sum_wheel = (int32_t)event.wheel + g_acc.ovf_wheel;
+    int32_t sum_pan = (int32_t)event.pan + g_acc.ovf_pan;
+    event.dx = (int16_t)clamp_s32(sum_dx, -32767, 32767);
+    event.dy = (int16_t)clamp_s32(sum_dy, -32767, 32767);
+    event.wheel = (int8_t)clamp_s32(sum_wheel, -127, 127);
+    event.pan = (int8_t)clamp_s32(sum_pan, -127, 127);
+    event.flags |= g_acc.ovf_flags;
+    g_acc.ovf_dx = sum_dx - event.dx;
+    g_acc.ovf_dy = sum_dy - event.dy;
+    g_acc.ovf_wheel = sum_wheel - event.wheel;
+    g_acc.ovf_pan = sum_pan - event.pan;
+    g_acc.ovf_flags = 0;
+    g_acc.ovf_valid = (g_acc.ovf_dx != 0 || g_acc.ovf_dy != 0 ||
+                       g_acc.ovf_wheel != 0 || g_acc.ovf_pan != 0);
+  }
+
   // Push到ring buffer
   bool success = ring_push(&event);
 
   if (!success)
   {
-    // 理论上不会失败(因为满了会覆盖最老)
-    // 但保留错误处理
-    ESP_LOGW(TAG, "Ring buffer push失败(不应发生)");
+    // Ring满(BLE长时间发不出去): 位移合并进溢出累加器而不是丢弃,
+    // 消费端本来就是对窗口积分,合并不改变积分结果,任意反压下无损
+    // (溢出期间的多次按钮变化会收敛为最终状态,与键盘溢出槽策略一致)
+    g_acc.ovf_dx += (int32_t)event.dx;
+    g_acc.ovf_dy += (int32_t)event.dy;
+    g_acc.ovf_wheel += (int32_t)event.wheel;
+    g_acc.ovf_pan += (int32_t)event.pan;
+    g_acc.ovf_flags |= event.flags;
+    g_acc.ovf_valid = true;
+    // 热路径不打日志,合并次数通过overflow_count统计接口观察
+  }
+
+  PERF_PROBE_END(PERF_STAGE_ACC_ADD);
+
+  // 空闲门控: 定时器停着就重启并立即发送(active时只是一次原子load)
+  if (!atomic_load(&s_timer_active))
+  {
+    ensure_timer_active();
   }
 
   // 调试日志(高频,正式版应关闭)
@@ -276,10 +463,29 @@ void mouse_accumulator_add(int16_t dx, int16_t dy, int8_t wheel, uint8_t buttons
 
 void mouse_accumulator_timer_callback(void *arg)
 {
-  mouse_accumulator_try_send();
+  // 只做轻量唤醒,不在esp_timer任务里走BLE栈,避免阻塞其他定时器客户端
+  if (s_tx_task != NULL)
+  {
+    xTaskNotifyGive(s_tx_task);
+  }
 }
 
-void mouse_accumulator_try_send(void)
+void HOT_PATH_IRAM_ATTR mouse_accumulator_request_send(void)
+{
+  if (s_tx_task == NULL)
+  {
+    return;
+  }
+  if (!atomic_load(&s_timer_active))
+  {
+    // idle时顺带重启周期节拍(发送失败的重试依赖后续tick)
+    ensure_timer_active(); // 内部已notify
+    return;
+  }
+  xTaskNotifyGive(s_tx_task);
+}
+
+void HOT_PATH_IRAM_ATTR mouse_accumulator_try_send(void)
 {
   // ========== 1. 前置检查 ==========
 
@@ -289,14 +495,24 @@ void mouse_accumulator_try_send(void)
     return; // BLE未连接,直接返回
   }
 
+  // 拥塞流控: 控制器队列满时不做注定失败的notify,
+  // 事件继续在ring中积分,拥塞解除事件会立即唤醒重发
+  if (hid_dev_is_congested())
+  {
+    return;
+  }
+
   // 获取当前时间
   uint64_t t_now = get_time_us();
 
   // ========== 2. 预览阶段: 遍历ring,计算时间窗积分 ==========
 
+  PERF_PROBE_BEGIN();
+
   int32_t sum_dx = g_acc.residual_dx; // 先加上残差
   int32_t sum_dy = g_acc.residual_dy;
   int32_t sum_wheel = g_acc.residual_wheel;
+  int32_t sum_pan = g_acc.residual_pan;
 
   uint8_t btn = g_acc.last_known_buttons; // 按钮初始值
   bool button_dirty = false;              // 窗内是否有按钮变化
@@ -321,6 +537,7 @@ void mouse_accumulator_try_send(void)
       sum_dx += (int32_t)event.dx;
       sum_dy += (int32_t)event.dy;
       sum_wheel += (int32_t)event.wheel;
+      sum_pan += (int32_t)event.pan;
 
       // 更新按钮状态(以最后一条为准)
       btn = event.buttons;
@@ -330,7 +547,7 @@ void mouse_accumulator_try_send(void)
       {
         button_dirty = true;
       }
-      if (event.dx != 0 || event.dy != 0 || event.wheel != 0)
+      if (event.dx != 0 || event.dy != 0 || event.wheel != 0 || event.pan != 0)
       {
         motion_dirty = true;
       }
@@ -364,14 +581,23 @@ void mouse_accumulator_try_send(void)
   int16_t dy_send = (int16_t)clamp_s32(sum_dy, -32767, 32767);
   int32_t new_residual_dy = sum_dy - dy_send;
 
-  // 滚轮: int8范围是 -127..127
-  int8_t wheel_send = (int8_t)clamp_s32(sum_wheel, -127, 127);
-  int32_t new_residual_wheel = sum_wheel - wheel_send;
+  // 滚轮/水平滚轮: hi-res模式下积分的是hi-res计数,
+  // 除以倍率发整detent,余数(分数detent)留在残差里跨窗口累积
+  int32_t divisor = (int32_t)s_wheel_divisor;
+  if (divisor < 1)
+  {
+    divisor = 1;
+  }
+  int8_t wheel_send = (int8_t)clamp_s32(sum_wheel / divisor, -127, 127);
+  int32_t new_residual_wheel = sum_wheel - (int32_t)wheel_send * divisor;
+
+  int8_t pan_send = (int8_t)clamp_s32(sum_pan / divisor, -127, 127);
+  int32_t new_residual_pan = sum_pan - (int32_t)pan_send * divisor;
 
   // ========== 5. 构建BLE鼠标报告 ==========
 
-  // 6字节报告: 按钮1 + X低1 + X高1 + Y低1 + Y高1 + 滚轮1
-  uint8_t ble_mouse_report[6] = {0};
+  // 7字节报告: 按钮1 + X低1 + X高1 + Y低1 + Y高1 + 滚轮1 + 水平滚轮1
+  uint8_t ble_mouse_report[7] = {0};
 
   // 字节0: 按钮(低5位，支持侧键)
   ble_mouse_report[0] = btn & 0x1F;
@@ -387,13 +613,30 @@ void mouse_accumulator_try_send(void)
   // 字节5: 滚轮(8位)
   ble_mouse_report[5] = (uint8_t)wheel_send;
 
+  // 字节6: 水平滚轮(AC Pan, 8位)
+  ble_mouse_report[6] = (uint8_t)pan_send;
+
+  PERF_PROBE_END(PERF_STAGE_ACC_INTEGRATE);
+
   // ========== 6. 尝试BLE notify ==========
-  esp_err_t ret = mouse_accumulator_send_ble_report(ble_mouse_report, 6);
+  esp_err_t ret = mouse_accumulator_send_ble_report(ble_mouse_report, 7);
 
   if (ret == ESP_OK)
   {
     // ========== 7. 发送成功: 提交阶段(两阶段提交的第二阶段) ==========
 
+    // 记录端到端延迟: USB回调打戳 -> notify成功提交
+    // (pop之前重新peek,事件仍在[tail, head)区间内)
+    uint64_t t_done = get_time_us();
+    for (uint32_t i = 0; i < num_to_consume; i++)
+    {
+      mouse_event_t event;
+      if (ring_peek(i, &event) && t_done > event.t_us)
+      {
+        latency_record((uint32_t)(t_done - event.t_us));
+      }
+    }
+
     // 真正pop掉消费的事件
     if (num_to_consume > 0)
     {
@@ -407,6 +650,7 @@ void mouse_accumulator_try_send(void)
     g_acc.residual_dx = new_residual_dx;
     g_acc.residual_dy = new_residual_dy;
     g_acc.residual_wheel = new_residual_wheel;
+    g_acc.residual_pan = new_residual_pan;
 
     // 更新按钮状态
     g_acc.last_known_buttons = btn;
@@ -415,10 +659,11 @@ void mouse_accumulator_try_send(void)
     g_acc.total_packets_sent++;
 
     // 调试日志
-    ESP_LOGD(TAG, "BLE发送成功: dx=%d, dy=%d, wh=%d, btn=0x%02X | 消费%lu事件, 残差[%ld,%ld,%ld]",
-             dx_send, dy_send, wheel_send, btn,
+    ESP_LOGD(TAG, "BLE发送成功: dx=%d, dy=%d, wh=%d, pan=%d, btn=0x%02X | 消费%lu事件, 残差[%ld,%ld,%ld,%ld]",
+             dx_send, dy_send, wheel_send, pan_send, btn,
              (unsigned long)num_to_consume,
-             (long)new_residual_dx, (long)new_residual_dy, (long)new_residual_wheel);
+             (long)new_residual_dx, (long)new_residual_dy,
+             (long)new_residual_wheel, (long)new_residual_pan);
   }
   else
   {
@@ -432,11 +677,30 @@ void mouse_accumulator_try_send(void)
     // 对于通知未启用的情况,不记录警告(这是正常状态)
     if (ret != ESP_ERR_INVALID_STATE)
     {
-      ESP_LOGW(TAG, "BLE发送失败(错误: %s), 保持状态不变,下次重试", esp_err_to_name(ret));
+      DLOGW1(TAG, "BLE发送失败(err=0x%x), 保持状态不变,下次重试", ret);
     }
   }
 }
 
+bool mouse_accumulator_is_active(void)
+{
+  return atomic_load(&s_timer_active);
+}
+
+void mouse_accumulator_set_wheel_divisor(uint8_t divisor)
+{
+  if (divisor < 1)
+  {
+    divisor = 1;
+  }
+  s_wheel_divisor = divisor;
+  // 倍率变化后旧残差的单位不再匹配,直接丢弃(最多损失不到1个detent)
+  g_acc.residual_wheel = 0;
+  g_acc.residual_pan = 0;
+  ESP_LOGI(TAG, "滚轮分辨率倍率已设置: %u (%s)", (unsigned int)divisor,
+           divisor > 1 ? "高分辨率滚轮" : "普通滚轮");
+}
+
 void mouse_accumulator_get_stats(uint32_t *events_in_ring,
                                  uint32_t *overflow_count,
                                  uint32_t *total_pushed,
@@ -444,22 +708,73 @@ void mouse_accumulator_get_stats(uint32_t *events_in_ring,
                                  uint32_t *total_sent,
                                  uint32_t *total_failures)
 {
-  portENTER_CRITICAL(&g_acc.ring.spinlock);
-  {
-    if (events_in_ring)
-      *events_in_ring = g_acc.ring.count;
-    if (overflow_count)
-      *overflow_count = g_acc.ring.overflow_count;
-    if (total_pushed)
-      *total_pushed = g_acc.total_events_pushed;
-    if (total_popped)
-      *total_popped = g_acc.total_events_popped;
-    if (total_sent)
-      *total_sent = g_acc.total_packets_sent;
-    if (total_failures)
-      *total_failures = g_acc.total_send_failures;
-  }
-  portEXIT_CRITICAL(&g_acc.ring.spinlock);
+  // 统计字段各自只有单一写者(生产者或消费者),读取快照无需加锁
+  if (events_in_ring)
+    *events_in_ring = ring_get_count();
+  if (overflow_count)
+    *overflow_count = g_acc.ring.overflow_count;
+  if (total_pushed)
+    *total_pushed = g_acc.total_events_pushed;
+  if (total_popped)
+    *total_popped = g_acc.total_events_popped;
+  if (total_sent)
+    *total_sent = g_acc.total_packets_sent;
+  if (total_failures)
+    *total_failures = g_acc.total_send_failures;
+}
+
+void mouse_accumulator_get_latency(latency_histogram_t *out)
+{
+  if (out)
+  {
+    // 消费者持续写入,快照可能有轻微撕裂,调试用途可接受
+    *out = s_latency;
+  }
+}
+
+void mouse_accumulator_log_latency(void)
+{
+  latency_histogram_t snap = s_latency;
+
+  if (snap.count == 0)
+  {
+    return;
+  }
+
+  // 从直方图估算p99: 累计计数达到99%的桶,取桶上界
+  uint32_t p99_threshold = (uint32_t)(((uint64_t)snap.count * 99 + 99) / 100);
+  uint32_t cumulative = 0;
+  uint32_t p99_us = LATENCY_HIST_BUCKETS * LATENCY_HIST_BUCKET_US;
+  for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+  {
+    cumulative += snap.buckets[i];
+    if (cumulative >= p99_threshold)
+    {
+      p99_us = (uint32_t)(i + 1) * LATENCY_HIST_BUCKET_US;
+      break;
+    }
+  }
+
+  ESP_LOGI(TAG, "USB->BLE延迟: 样本=%lu, min=%luus, avg=%lluus, p99<=%luus, max=%luus",
+           (unsigned long)snap.count,
+           (unsigned long)snap.min_us,
+           (unsigned long long)(snap.sum_us / snap.count),
+           (unsigned long)p99_us,
+           (unsigned long)snap.max_us);
+
+  // 直方图: 每桶1ms,最后一桶为>=15ms
+  char hist_str[LATENCY_HIST_BUCKETS * 12];
+  int pos = 0;
+  for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+  {
+    pos += snprintf(hist_str + pos, sizeof(hist_str) - pos, "%s%lu",
+                    (i == 0) ? "" : " ", (unsigned long)snap.buckets[i]);
+    if (pos >= (int)sizeof(hist_str) - 1)
+    {
+      break;
+    }
+  }
+  ESP_LOGI(TAG, "  直方图[1ms/桶]: %s", hist_str);
 }
 
 esp_err_t mouse_accumulator_update_send_interval(uint16_t conn_interval_units)
@@ -495,18 +810,26 @@ esp_err_t mouse_accumulator_update_send_interval(uint16_t conn_interval_units)
     return ESP_OK;
   }
 
+  // 更新间隔
+  uint32_t old_interval_us = s_current_send_interval_us;
+  s_current_send_interval_us = new_interval_us;
+
+  // 空闲门控下定时器可能已停止: 只记录新间隔,下次idle->active时生效
+  if (!atomic_load(&s_timer_active))
+  {
+    ESP_LOGI(TAG, "定时器处于idle,新发送间隔%u us将在下次唤醒时生效", (unsigned int)new_interval_us);
+    return ESP_OK;
+  }
+
   // 停止当前定时器
   esp_err_t ret = esp_timer_stop(s_send_timer);
   if (ret != ESP_OK)
   {
     ESP_LOGE(TAG, "停止定时器失败: %s", esp_err_to_name(ret));
+    s_current_send_interval_us = old_interval_us;
     return ret;
   }
 
-  // 更新间隔
-  uint32_t old_interval_us = s_current_send_interval_us;
-  s_current_send_interval_us = new_interval_us;
-
   // 重新启动定时器
   ret = esp_timer_start_periodic(s_send_timer, s_current_send_interval_us);
   if (ret != ESP_OK)
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "esp_err.h"
 #include "esp_timer.h"
@@ -36,6 +37,25 @@ extern "C"
 #define RING_BUFFER_CAPACITY 128
 #define RING_BUFFER_MASK (RING_BUFFER_CAPACITY - 1)
 
+// 空闲门控: 连续N个空窗口(无事件、无残差)后停止周期定时器
+// 8 * 7.5ms = 60ms无输入即进入idle,不再有每秒~133次的空唤醒,
+// 也不再阻碍light-sleep; 第一条新事件会立即唤醒并重启节拍
+#define IDLE_EMPTY_WINDOWS_THRESHOLD 8
+
+// 端到端延迟直方图配置
+// 桶宽1ms,覆盖0~15ms,超出部分计入最后一个桶
+// 测量范围: USB回调打戳(t_us) -> notify成功提交
+#define LATENCY_HIST_BUCKETS 16
+#define LATENCY_HIST_BUCKET_US 1000
+
+// BLE发送任务配置
+// 固定到core 1(与core 0上的usb_lib_task/HID驱动任务错开),
+// USB输入和BLE发送在双核S3上形成真正的流水线并行
+// 优先级高于HID驱动任务(5),保证节拍到达时立即执行
+#define BLE_TX_TASK_STACK_SIZE 4096
+#define BLE_TX_TASK_PRIORITY 10
+#define BLE_TX_TASK_CORE 1
+
    /* =================================================================================================
       类型定义
       ================================================================================================= */
@@ -50,7 +70,8 @@ extern "C"
       uint64_t t_us;   // 时间戳(微秒)
       int16_t dx;      // X位移(原始值)
       int16_t dy;      // Y位移(原始值)
-      int8_t wheel;    // 滚轮位移
+      int8_t wheel;    // 滚轮位移(启用高分辨率滚轮时为hi-res计数)
+      int8_t pan;      // 水平滚轮位移(AC Pan,无则为0)
       uint8_t buttons; // 按钮状态(低3位: 左中右)
       uint8_t flags;   // 标志位: bit0=button_changed
    } mouse_event_t;
@@ -59,21 +80,23 @@ extern "C"
 #define EVENT_FLAG_BUTTON_CHANGED 0x01
 
    /**
-    * @brief Ring buffer结构体
+    * @brief Ring buffer结构体 (无锁SPSC设计)
+    *
+    * 单生产者(USB回调): 写入head位置,head++ (release)
+    * 单消费者(发送节拍): 读取tail位置,tail++ (release)
+    * head/tail自由递增,索引用 & RING_BUFFER_MASK 取模
+    * 满条件: head - tail == CAPACITY
+    * 空条件: head == tail
     *
-    * 生产者(USB task): 写入head位置,head++
-    * 消费者(BLE task): 读取tail位置,tail++
-    * 满条件: count == CAPACITY
-    * 空条件: count == 0
+    * 用C11原子的acquire/release顺序替代原来的portENTER_CRITICAL自旋锁,
+    * 输入热路径不再有任何关中断窗口
     */
    typedef struct
    {
       mouse_event_t events[RING_BUFFER_CAPACITY]; // 事件数组
-      volatile uint32_t head;                     // 写入索引(生产者)
-      volatile uint32_t tail;                     // 读取索引(消费者)
-      volatile uint32_t count;                    // 当前事件数
-      volatile uint32_t overflow_count;           // 溢出计数(调试用)
-      portMUX_TYPE spinlock;                      // 保护并发访问
+      _Atomic uint32_t head;                      // 写入索引(仅生产者递增)
+      _Atomic uint32_t tail;                      // 读取索引(仅消费者递增)
+      uint32_t overflow_count;                    // 溢出合并计数(仅生产者写,调试用)
    } mouse_event_ring_t;
 
    /**
@@ -90,9 +113,22 @@ extern "C"
       uint64_t t_last_send_us; // 上次发送的截止时间(微秒)
 
       // 残差累积器(处理饱和后的剩余)
+      // 启用高分辨率滚轮时wheel/pan残差还承担分数detent:
+      // hi-res计数积分后除以倍率发整detent,余数留在残差里跨窗口累积
       int32_t residual_dx;
       int32_t residual_dy;
       int32_t residual_wheel;
+      int32_t residual_pan;
+
+      // 溢出合并累加器(仅生产者访问)
+      // ring满时把被挤出的位移累积在这里而不是丢弃,
+      // 腾出空间后随下一条事件折叠回ring,BLE反压下位移无损
+      int32_t ovf_dx;
+      int32_t ovf_dy;
+      int32_t ovf_wheel;
+      int32_t ovf_pan;
+      uint8_t ovf_flags; // 溢出期间累积的事件标志(按钮变化不丢失)
+      bool ovf_valid;    // 溢出累加器是否有待折叠数据
 
       // 按钮状态管理
       uint8_t last_known_buttons; // 最后一次发送的按钮状态
@@ -106,6 +142,20 @@ extern "C"
 
    } mouse_motion_accumulator_t;
 
+   /**
+    * @brief USB到BLE的端到端延迟直方图
+    *
+    * 仅消费者(ble_tx任务)写入,读取方拿到的是近似快照
+    */
+   typedef struct
+   {
+      uint32_t buckets[LATENCY_HIST_BUCKETS]; // 固定桶计数
+      uint32_t count;                         // 总样本数
+      uint32_t min_us;                        // 最小延迟(微秒)
+      uint32_t max_us;                        // 最大延迟(微秒)
+      uint64_t sum_us;                        // 延迟总和(算平均用)
+   } latency_histogram_t;
+
    /* =================================================================================================
       函数声明
       ================================================================================================= */
@@ -131,18 +181,32 @@ extern "C"
     *
     * 只负责push事件到ring,不触发BLE发送
     * BLE发送由定时器按固定节拍触发
+    * 若定时器已因空闲停止,首条新事件会重启节拍并立即触发一次发送
     *
     * @param dx X轴位移(int16)
     * @param dy Y轴位移(int16)
-    * @param wheel 滚轮位移(int8)
+    * @param wheel 滚轮位移(int8,hi-res模式下为原始hi-res计数)
+    * @param pan 水平滚轮位移(int8,无则传0)
     * @param buttons 按钮状态(低3位有效)
     */
-   void mouse_accumulator_add(int16_t dx, int16_t dy, int8_t wheel, uint8_t buttons);
+   void mouse_accumulator_add(int16_t dx, int16_t dy, int8_t wheel, int8_t pan, uint8_t buttons);
+
+   /**
+    * @brief 设置滚轮分辨率倍率(高分辨率滚轮)
+    *
+    * 枚举阶段对USB鼠标SET_FEATURE启用Resolution Multiplier后调用,
+    * 之后wheel/pan按hi-res计数积分,发送时除以倍率发整detent,
+    * 余数经残差机制跨窗口累积(分数detent不丢失)
+    *
+    * @param divisor 倍率(1=普通滚轮,鼠标断开时应重置为1)
+    */
+   void mouse_accumulator_set_wheel_divisor(uint8_t divisor);
 
    /**
     * @brief BLE发送定时器回调函数(内部使用)
     *
-    * 由esp_timer定期调用,触发节拍发送
+    * 由esp_timer定期调用,通过任务通知唤醒ble_tx发送任务
+    * (实际的积分和notify在ble_tx任务中执行,不占用esp_timer任务)
     *
     * @param arg 未使用
     */
@@ -160,10 +224,26 @@ extern "C"
     * 6. 成功: 提交阶段,真正pop事件,更新t_last_send和residual
     * 7. 失败: 不pop,保持状态不变,下次重试
     *
-    * 此函数由定时器回调触发
+    * 此函数由ble_tx发送任务在收到节拍通知后调用
     */
    void mouse_accumulator_try_send(void);
 
+   /**
+    * @brief 立即唤醒ble_tx发送任务(不等下一个定时器节拍)
+    *
+    * 供其他输入模块(如键盘队列)在有新数据时调用,降低首包延迟
+    * 若周期定时器处于idle状态,会顺带重启节拍(保证失败重试有后续tick)
+    */
+   void mouse_accumulator_request_send(void);
+
+   /**
+    * @brief 查询发送定时器是否处于active状态
+    *
+    * active表示最近60ms内有输入在流动,供连接参数协商引擎
+    * 判断输入是否空闲
+    */
+   bool mouse_accumulator_is_active(void);
+
    /**
     * @brief 获取ring buffer统计信息(调试用)
     */
@@ -174,6 +254,18 @@ extern "C"
                                     uint32_t *total_sent,
                                     uint32_t *total_failures);
 
+   /**
+    * @brief 获取端到端延迟直方图快照(调试用)
+    */
+   void mouse_accumulator_get_latency(latency_histogram_t *out);
+
+   /**
+    * @brief 打印延迟统计日志(count/min/avg/p99/max + 直方图)
+    *
+    * 供心跳日志等周期性场景调用,没有样本时不打印
+    */
+   void mouse_accumulator_log_latency(void);
+
    /**
     * @brief 根据实际BLE连接间隔动态更新发送间隔
     *
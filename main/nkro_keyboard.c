@@ -0,0 +1,293 @@
+/*
+ * NKRO Keyboard Bitmap Report - Implementation File
+ *
+ * 核心逻辑:
+ * - 翻译: 修饰键字节直通, 数组里的每个键码(0x04..0x77)置位到位图
+ * - ErrorRollOver(0x01)/POST Fail(0x02): 数组不可信,保持上次位图
+ * - 合并策略: 相同状态去重;队列满时过渡感知合并——新状态N能覆盖
+ *   待发状态L的条件是: 相对上一个已保序状态P, L的每个边沿在N里方向
+ *   不变(没有"L按下而N又释放"的tap, 也没有"L释放而N又按下"的retap)
+ */
+
+#include "nkro_keyboard.h"
+#include "esp_log.h"
+#include "hid_dev.h"
+#include "hot_path.h"
+#include "hid_host_example.h"
+#include "mouse_accumulator.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "NKRO_KB";
+
+// 键码翻译常量
+#define NKRO_KEY_ERR_ROLLOVER 0x01
+#define NKRO_KEY_POST_FAIL 0x02
+#define NKRO_KEY_ERR_UNDEFINED 0x03
+#define NKRO_KEY_FIRST_VALID 0x04
+
+// 溢出缓冲深度: 队列满时最多再保序暂存这么多不可合并的过渡,
+// 再满则退化为只保留最新状态(与keyboard_queue的溢出槽行为一致)
+#define NKRO_OVERFLOW_DEPTH 4
+
+// 队列条目: 一条完整的NKRO输入报告(修饰键 + 位图)
+typedef struct
+{
+  uint8_t report[NKRO_RPT_LEN];
+} nkro_entry_t;
+
+// 无锁SPSC队列(与keyboard_queue同样的head/tail设计)
+typedef struct
+{
+  nkro_entry_t entries[NKRO_QUEUE_CAPACITY];
+  _Atomic uint32_t head; // 写入索引(仅生产者递增)
+  _Atomic uint32_t tail; // 读取索引(仅消费者递增)
+} nkro_queue_t;
+
+static nkro_queue_t g_queue = {
+    .head = 0,
+    .tail = 0};
+
+// 生产者端状态(仅USB回调访问)
+static uint8_t s_last_state[NKRO_RPT_LEN]; // 最近翻译出的状态(去重+rollover恢复用)
+static bool s_last_state_valid = false;
+
+// 溢出缓冲: 队列满时保序暂存过渡,腾出空间后优先补发
+static nkro_entry_t s_overflow[NKRO_OVERFLOW_DEPTH];
+static int s_overflow_count = 0;
+static uint8_t s_before_overflow[NKRO_RPT_LEN]; // 溢出前最后一个已入队的状态(边沿基准)
+
+// 统计(各自只有单一写者)
+static uint32_t s_total_pushed = 0;
+static uint32_t s_total_sent = 0;
+static uint32_t s_total_coalesced = 0;
+static uint32_t s_total_failures = 0;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+static uint32_t HOT_PATH_IRAM_ATTR queue_count(void)
+{
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  return head - tail;
+}
+
+// 生产者: 尝试写入一条报告,满时返回false
+static bool HOT_PATH_IRAM_ATTR queue_push_raw(const nkro_entry_t *entry)
+{
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_acquire);
+
+  if (head - tail >= NKRO_QUEUE_CAPACITY)
+  {
+    return false;
+  }
+
+  g_queue.entries[head & NKRO_QUEUE_MASK] = *entry;
+  atomic_store_explicit(&g_queue.head, head + 1, memory_order_release);
+  return true;
+}
+
+/**
+ * @brief 判断中间状态mid能否被next覆盖而不丢失按下/释放边沿
+ *
+ * prev→mid的每个边沿必须在prev→next里同向存在:
+ * - (mid & ~prev) & ~next != 0: mid新按下的键在next里已释放(tap会丢)
+ * - (prev & ~mid) & next != 0: mid释放的键在next里又按下(retap会丢)
+ * 修饰键字节和位图按同样的规则逐字节检查
+ */
+static bool HOT_PATH_IRAM_ATTR nkro_merge_safe(const uint8_t *prev, const uint8_t *mid, const uint8_t *next)
+{
+  for (int i = 0; i < NKRO_RPT_LEN; i++)
+  {
+    uint8_t made = (uint8_t)(mid[i] & ~prev[i]);   // prev→mid按下的键
+    uint8_t broke = (uint8_t)(prev[i] & ~mid[i]);  // prev→mid释放的键
+    if ((made & (uint8_t)~next[i]) != 0 || (broke & next[i]) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 把USB键盘报告翻译成NKRO位图状态
+ *
+ * Boot Protocol和Report Protocol的键盘报告结构相同
+ * (修饰键1 + 保留1 + 键码数组), 只是数组长度可能不同
+ */
+static void HOT_PATH_IRAM_ATTR nkro_translate(const uint8_t *report, int length, uint8_t *out)
+{
+  out[0] = report[0]; // 修饰键字节直通(E0..E7位图)
+  memset(&out[1], 0, NKRO_BITMAP_BYTES);
+
+  for (int i = 2; i < length; i++)
+  {
+    uint8_t key = report[i];
+    if (key >= NKRO_KEY_ERR_ROLLOVER && key <= NKRO_KEY_ERR_UNDEFINED)
+    {
+      // 滚转错误/POST错误: 数组内容不可信,保持上次的按键位图
+      // (修饰键字节仍然有效,已在上面更新)
+      if (s_last_state_valid)
+      {
+        memcpy(&out[1], &s_last_state[1], NKRO_BITMAP_BYTES);
+      }
+      return;
+    }
+    if (key >= NKRO_KEY_FIRST_VALID && key <= NKRO_KEY_USAGE_MAX)
+    {
+      out[1 + (key >> 3)] |= (uint8_t)(1 << (key & 0x07));
+    }
+  }
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+void nkro_keyboard_init(void)
+{
+  nkro_keyboard_clear();
+  ESP_LOGI(TAG, "NKRO发送队列初始化成功(容量: %d条报告, 位图: %d键)",
+           NKRO_QUEUE_CAPACITY, NKRO_BITMAP_BYTES * 8);
+}
+
+void nkro_keyboard_clear(void)
+{
+  // 消费者方式排空: tail推进到head(保持SPSC约束,不重置索引)
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  atomic_store_explicit(&g_queue.tail, head, memory_order_release);
+  s_overflow_count = 0;
+  s_last_state_valid = false;
+}
+
+void HOT_PATH_IRAM_ATTR nkro_keyboard_push(const uint8_t *report, int length)
+{
+  if (report == NULL || length < 8)
+  {
+    return;
+  }
+
+  nkro_entry_t entry;
+  nkro_translate(report, length, entry.report);
+
+  // 去重: 与最近的状态完全相同的报告没有信息量,直接丢弃
+  // (按下/释放必然产生不同的状态,过渡不会被去重吃掉)
+  if (s_last_state_valid &&
+      memcmp(s_last_state, entry.report, NKRO_RPT_LEN) == 0 &&
+      s_overflow_count == 0)
+  {
+    s_total_coalesced++;
+    return;
+  }
+
+  // 先补发之前因队列满暂存的溢出报告,保持顺序
+  while (s_overflow_count > 0 && queue_push_raw(&s_overflow[0]))
+  {
+    memcpy(s_before_overflow, s_overflow[0].report, NKRO_RPT_LEN);
+    memmove(&s_overflow[0], &s_overflow[1],
+            (size_t)(s_overflow_count - 1) * sizeof(nkro_entry_t));
+    s_overflow_count--;
+    s_total_pushed++;
+  }
+
+  if (s_overflow_count == 0 && queue_push_raw(&entry))
+  {
+    memcpy(s_before_overflow, entry.report, NKRO_RPT_LEN);
+    s_total_pushed++;
+  }
+  else
+  {
+    // 队列仍满: 过渡感知合并进溢出缓冲
+    if (s_overflow_count == 0)
+    {
+      s_overflow[0] = entry;
+      s_overflow_count = 1;
+    }
+    else
+    {
+      // 边沿基准P: 溢出缓冲最后一条之前的状态
+      const uint8_t *prev = (s_overflow_count >= 2)
+                                ? s_overflow[s_overflow_count - 2].report
+                                : s_before_overflow;
+      if (nkro_merge_safe(prev, s_overflow[s_overflow_count - 1].report, entry.report))
+      {
+        // 最后一条的边沿在新状态里都保留,可以直接覆盖
+        s_overflow[s_overflow_count - 1] = entry;
+        s_total_coalesced++;
+      }
+      else if (s_overflow_count < NKRO_OVERFLOW_DEPTH)
+      {
+        s_overflow[s_overflow_count++] = entry;
+      }
+      else
+      {
+        // 溢出缓冲也满: 退化为只保留最新状态(中间过渡被取代,最终状态不丢)
+        s_overflow[s_overflow_count - 1] = entry;
+        s_total_coalesced++;
+      }
+    }
+  }
+
+  memcpy(s_last_state, entry.report, NKRO_RPT_LEN);
+  s_last_state_valid = true;
+
+  // 立即唤醒发送任务,不等下一个定时器节拍(降低按键延迟)
+  mouse_accumulator_request_send();
+}
+
+void HOT_PATH_IRAM_ATTR nkro_keyboard_try_send(void)
+{
+  if (!mouse_accumulator_is_ble_connected())
+  {
+    return;
+  }
+
+  // 拥塞流控: 控制器队列满时报告留在队列中,拥塞解除后再发
+  if (hid_dev_is_congested())
+  {
+    return;
+  }
+
+  // 依次发送所有待发报告;失败时停止,剩余报告下个节拍重试
+  while (queue_count() > 0)
+  {
+    uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+    nkro_entry_t *entry = &g_queue.entries[tail & NKRO_QUEUE_MASK];
+
+    esp_err_t ret = nkro_keyboard_send_ble_report(entry->report, NKRO_RPT_LEN);
+    if (ret != ESP_OK)
+    {
+      s_total_failures++;
+      // 通知未启用是正常状态,不打日志
+      if (ret != ESP_ERR_INVALID_STATE)
+      {
+        ESP_LOGW(TAG, "NKRO报告发送失败(%s),保留队列下次重试", esp_err_to_name(ret));
+      }
+      return;
+    }
+
+    atomic_store_explicit(&g_queue.tail, tail + 1, memory_order_release);
+    s_total_sent++;
+  }
+}
+
+void nkro_keyboard_get_stats(uint32_t *pending,
+                             uint32_t *total_pushed,
+                             uint32_t *total_sent,
+                             uint32_t *total_coalesced,
+                             uint32_t *total_failures)
+{
+  if (pending)
+    *pending = queue_count() + (uint32_t)s_overflow_count;
+  if (total_pushed)
+    *total_pushed = s_total_pushed;
+  if (total_sent)
+    *total_sent = s_total_sent;
+  if (total_coalesced)
+    *total_coalesced = s_total_coalesced;
+  if (total_failures)
+    *total_failures = s_total_failures;
+}
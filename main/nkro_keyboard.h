@@ -0,0 +1,79 @@
+/*
+ * NKRO Keyboard Bitmap Report - Header File
+ *
+ * 核心思想:
+ * - 把USB侧的键盘报告(Boot Protocol 6键数组或Report Protocol数组)翻译成
+ *   位图报告: 修饰键1字节 + 按键位图15字节(Usage 0x00..0x77, 每键1bit)
+ * - 位图报告通过独立的Report ID 6发送,不再受6键滚转(6KRO)限制
+ * - 过渡感知合并: 队列满时只合并不丢失按下/释放边沿的相邻状态,
+ *   快速的make/break序列压缩成保序的最小报告集
+ */
+
+#ifndef NKRO_KEYBOARD_H__
+#define NKRO_KEYBOARD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 队列容量(必须是2的幂, 与keyboard_queue相同的SPSC设计)
+#define NKRO_QUEUE_CAPACITY 16
+#define NKRO_QUEUE_MASK (NKRO_QUEUE_CAPACITY - 1)
+
+// 位图覆盖Usage 0x00..0x77(120键), 修饰键E0..E7单独占1字节
+#define NKRO_BITMAP_BYTES 15
+#define NKRO_KEY_USAGE_MAX 0x77
+
+// 报告长度: 修饰键1 + 位图15 = 16字节(默认MTU 23下单包可发)
+#define NKRO_RPT_LEN (1 + NKRO_BITMAP_BYTES)
+
+  /**
+   * @brief 初始化NKRO发送队列
+   */
+  void nkro_keyboard_init(void);
+
+  /**
+   * @brief 清空队列和按键状态(断线重连等场景)
+   */
+  void nkro_keyboard_clear(void);
+
+  /**
+   * @brief USB键盘报告翻译入队(Producer,USB回调上下文调用)
+   *
+   * 把修饰键+按键数组翻译成位图状态后入队;
+   * ErrorRollOver/POST错误数组保持上一次的按键位图(修饰键仍然更新);
+   * 队列满时做过渡感知合并: 只有不丢失按下/释放边沿时才用新状态
+   * 覆盖最近的待发状态,否则追加到溢出缓冲
+   *
+   * @param report 键盘报告(修饰键+保留+按键数组)
+   * @param length 报告长度(至少8字节)
+   */
+  void nkro_keyboard_push(const uint8_t *report, int length);
+
+  /**
+   * @brief 取出待发报告并通过BLE发送(Consumer,ble_tx任务调用)
+   *
+   * 与keyboard_queue_try_send同样的节奏: 依次notify,
+   * 发送失败时停止并保留剩余报告,下个节拍重试
+   */
+  void nkro_keyboard_try_send(void);
+
+  /**
+   * @brief 获取队列统计信息(调试用)
+   */
+  void nkro_keyboard_get_stats(uint32_t *pending,
+                               uint32_t *total_pushed,
+                               uint32_t *total_sent,
+                               uint32_t *total_coalesced,
+                               uint32_t *total_failures);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NKRO_KEYBOARD_H__ */
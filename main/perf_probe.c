@@ -0,0 +1,74 @@
+/*
+ * 分段性能探针 - 实现文件
+ *
+ * 只有统计表的dump逻辑在这里;采样路径(perf_probe_commit)是header inline,
+ * 避免热路径上的函数调用开销
+ */
+
+#include "perf_probe.h"
+
+#if defined(CONFIG_PERF_PROBES) && CONFIG_PERF_PROBES
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "PERF";
+
+perf_stage_stats_t g_perf_stages[PERF_STAGE_COUNT];
+
+// 阶段名(与perf_stage_t顺序一致)
+static const char *s_stage_names[PERF_STAGE_COUNT] = {
+    "mouse-extract",
+    "acc-add",
+    "acc-integrate",
+    "ble-notify",
+};
+
+// 上次dump时间(算每秒速率用)
+static int64_t s_last_dump_us = 0;
+
+void perf_probe_log_table(void)
+{
+  int64_t now = esp_timer_get_time();
+  int64_t elapsed_us = (s_last_dump_us != 0) ? (now - s_last_dump_us) : 0;
+
+  uint32_t total_calls = 0;
+  for (int i = 0; i < PERF_STAGE_COUNT; i++)
+  {
+    total_calls += g_perf_stages[i].calls;
+  }
+  if (total_calls == 0)
+  {
+    s_last_dump_us = now;
+    return; // 区间内无采样(空闲),不刷屏
+  }
+
+  ESP_LOGI(TAG, "---- 分段周期统计 (区间%.1fs) ----",
+           elapsed_us > 0 ? elapsed_us / 1000000.0 : 0.0);
+  ESP_LOGI(TAG, "%-14s %8s %10s %10s %8s", "stage", "calls", "avg_cyc", "max_cyc", "rate/s");
+  for (int i = 0; i < PERF_STAGE_COUNT; i++)
+  {
+    perf_stage_stats_t *s = &g_perf_stages[i];
+    if (s->calls == 0)
+    {
+      continue;
+    }
+    uint32_t avg = (uint32_t)(s->total_cycles / s->calls);
+    uint32_t rate = (elapsed_us > 0)
+                        ? (uint32_t)((uint64_t)s->calls * 1000000ULL / (uint64_t)elapsed_us)
+                        : 0;
+    ESP_LOGI(TAG, "%-14s %8lu %10lu %10lu %8lu",
+             s_stage_names[i],
+             (unsigned long)s->calls,
+             (unsigned long)avg,
+             (unsigned long)s->max_cycles,
+             (unsigned long)rate);
+    // 按区间清零(各阶段在自己的任务里并发累加,清零竞争最多丢一次采样)
+    s->calls = 0;
+    s->total_cycles = 0;
+    s->max_cycles = 0;
+  }
+  s_last_dump_us = now;
+}
+
+#endif /* CONFIG_PERF_PROBES */
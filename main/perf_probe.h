@@ -0,0 +1,83 @@
+/*
+ * 分段性能探针 - 头文件
+ *
+ * 核心思想:
+ * - 端到端延迟直方图只能说明"慢",不能说明"慢在哪";
+ *   探针按阶段读CPU周期计数器,累计每阶段的调用数/总周期/最大周期
+ * - 由CONFIG_PERF_PROBES门控,关闭时宏展开为空,零开销;
+ *   打开时每个探针只是两次周期计数器读取加几次普通写
+ * - 周期表随心跳日志定期输出(本仓库没有console REPL,
+ *   固定节拍dump与延迟直方图的输出方式保持一致)
+ */
+
+#ifndef PERF_PROBE_H__
+#define PERF_PROBE_H__
+
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // 被测阶段(新增阶段同时更新perf_probe.c里的名字表)
+  typedef enum
+  {
+    PERF_STAGE_MOUSE_EXTRACT = 0, // 鼠标报告字段提取(plan路径)
+    PERF_STAGE_ACC_ADD,           // 累加器事件构建+ring push
+    PERF_STAGE_ACC_INTEGRATE,     // 时间窗积分+报告构建(notify之前)
+    PERF_STAGE_BLE_NOTIFY,        // CCCD检查+esp_ble_gatts_send_indicate
+    PERF_STAGE_COUNT
+  } perf_stage_t;
+
+#if defined(CONFIG_PERF_PROBES) && CONFIG_PERF_PROBES
+
+#include "esp_cpu.h"
+
+  // 单阶段统计(每个阶段只在一个任务里执行,普通写即可)
+  typedef struct
+  {
+    uint32_t calls;       // 调用次数
+    uint64_t total_cycles; // 总周期数
+    uint32_t max_cycles;  // 单次最大周期数
+  } perf_stage_stats_t;
+
+  extern perf_stage_stats_t g_perf_stages[PERF_STAGE_COUNT];
+
+  static inline void perf_probe_commit(perf_stage_t stage, uint32_t cycles)
+  {
+    perf_stage_stats_t *s = &g_perf_stages[stage];
+    s->calls++;
+    s->total_cycles += cycles;
+    if (cycles > s->max_cycles)
+    {
+      s->max_cycles = cycles;
+    }
+  }
+
+// 在同一作用域内配对使用: BEGIN声明起点,END提交差值
+#define PERF_PROBE_BEGIN() uint32_t perf_probe_t0_ = esp_cpu_get_cycle_count()
+#define PERF_PROBE_END(stage) perf_probe_commit((stage), esp_cpu_get_cycle_count() - perf_probe_t0_)
+
+  /**
+   * @brief 输出各阶段周期统计表(calls/avg/max/速率)并清零
+   *
+   * 随心跳日志周期性调用;区间内没有任何采样时不打印
+   */
+  void perf_probe_log_table(void);
+
+#else /* !CONFIG_PERF_PROBES */
+
+#define PERF_PROBE_BEGIN() do {} while (0)
+#define PERF_PROBE_END(stage) do {} while (0)
+
+  static inline void perf_probe_log_table(void) {}
+
+#endif /* CONFIG_PERF_PROBES */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERF_PROBE_H__ */
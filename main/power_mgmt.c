@@ -0,0 +1,180 @@
+/*
+ * Idle Power Management - 实现文件
+ *
+ * 状态机只有两态: ACTIVE持有pm锁保证全速转发,
+ * IDLE释放锁交给esp_pm的DFS(和可选的自动light-sleep)。
+ * 空闲判定复用累加器定时器的active标志,和conn_params的
+ * 空闲检测走同一套1秒采样模式。
+ */
+
+#include "power_mgmt.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mouse_accumulator.h"
+#include "sdkconfig.h"
+
+#if defined(CONFIG_PM_ENABLE) && CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+static const char *TAG = "POWER_MGMT";
+
+/* =================================================================================================
+   内部状态
+   ================================================================================================= */
+
+static power_mgmt_mode_t s_mode = POWER_MGMT_MODE_ACTIVE;
+static esp_timer_handle_t s_idle_timer = NULL;
+static int64_t s_last_activity_us = 0;
+static bool s_pm_available = false;
+
+#if defined(CONFIG_PM_ENABLE) && CONFIG_PM_ENABLE
+// 活动期间持有: CPU锁定最高频,禁止light-sleep
+static esp_pm_lock_handle_t s_cpu_lock = NULL;
+static esp_pm_lock_handle_t s_sleep_lock = NULL;
+#endif
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+/**
+ * @brief 进入省电模式: 释放pm锁
+ *
+ * CPU锁释放后DFS立即降到min_freq;light-sleep锁只在
+ * CONFIG_IDLE_LIGHT_SLEEP打开时才释放(见头文件的USB host注意事项)
+ */
+static void enter_power_idle(void)
+{
+#if defined(CONFIG_PM_ENABLE) && CONFIG_PM_ENABLE
+  esp_pm_lock_release(s_cpu_lock);
+#if defined(CONFIG_IDLE_LIGHT_SLEEP) && CONFIG_IDLE_LIGHT_SLEEP
+  esp_pm_lock_release(s_sleep_lock);
+#endif
+#endif
+  s_mode = POWER_MGMT_MODE_IDLE;
+  ESP_LOGI(TAG, "输入空闲%d秒,进入省电模式(DFS降频%s)",
+           CONFIG_IDLE_POWER_TIMEOUT_S,
+#if defined(CONFIG_IDLE_LIGHT_SLEEP) && CONFIG_IDLE_LIGHT_SLEEP
+           "+自动light-sleep"
+#else
+           ""
+#endif
+  );
+}
+
+/**
+ * @brief 空闲检测定时器回调(esp_timer任务,1秒周期)
+ */
+static void idle_check_callback(void *arg)
+{
+  int64_t now = esp_timer_get_time();
+  if (mouse_accumulator_is_active())
+  {
+    s_last_activity_us = now;
+    return;
+  }
+
+  if (s_mode == POWER_MGMT_MODE_ACTIVE &&
+      (now - s_last_activity_us) >= (int64_t)CONFIG_IDLE_POWER_TIMEOUT_S * 1000000)
+  {
+    enter_power_idle();
+  }
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+esp_err_t power_mgmt_init(void)
+{
+#if defined(CONFIG_PM_ENABLE) && CONFIG_PM_ENABLE
+  // DFS配置: 上限保持sdkconfig默认主频,下限降到XTAL(40MHz)
+  esp_pm_config_t pm_config = {
+      .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+      .min_freq_mhz = 40,
+#if defined(CONFIG_IDLE_LIGHT_SLEEP) && CONFIG_IDLE_LIGHT_SLEEP
+      .light_sleep_enable = true,
+#else
+      .light_sleep_enable = false,
+#endif
+  };
+  esp_err_t ret = esp_pm_configure(&pm_config);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGW(TAG, "DFS配置失败(%s),电源管理降级为no-op", esp_err_to_name(ret));
+    return ESP_OK;
+  }
+
+  ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "input_cpu", &s_cpu_lock);
+  if (ret == ESP_OK)
+  {
+    ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "input_nosleep", &s_sleep_lock);
+  }
+  if (ret != ESP_OK)
+  {
+    ESP_LOGE(TAG, "创建pm锁失败: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  // 启动即ACTIVE: 两把锁都持有,USB枚举/BLE配对期间不降频
+  esp_pm_lock_acquire(s_cpu_lock);
+  esp_pm_lock_acquire(s_sleep_lock);
+  s_pm_available = true;
+#else
+  ESP_LOGW(TAG, "sdkconfig未启用CONFIG_PM_ENABLE,电源管理降级为no-op");
+  return ESP_OK;
+#endif
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = &idle_check_callback,
+      .arg = NULL,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "power_idle_check"};
+
+  esp_err_t timer_ret = esp_timer_create(&timer_args, &s_idle_timer);
+  if (timer_ret != ESP_OK)
+  {
+    ESP_LOGE(TAG, "创建空闲检测定时器失败: %s", esp_err_to_name(timer_ret));
+    return timer_ret;
+  }
+  s_last_activity_us = esp_timer_get_time();
+  esp_timer_start_periodic(s_idle_timer, (uint64_t)POWER_MGMT_IDLE_CHECK_MS * 1000);
+
+  ESP_LOGI(TAG, "电源管理初始化完成(空闲阈值: %d秒, light-sleep: %s)",
+           CONFIG_IDLE_POWER_TIMEOUT_S,
+#if defined(CONFIG_IDLE_LIGHT_SLEEP) && CONFIG_IDLE_LIGHT_SLEEP
+           "启用"
+#else
+           "关闭"
+#endif
+  );
+  return ESP_OK;
+}
+
+void power_mgmt_notify_activity(void)
+{
+  if (!s_pm_available)
+  {
+    return;
+  }
+  s_last_activity_us = esp_timer_get_time();
+
+  // 省电模式下第一条输入立即重新持锁回全速
+  if (s_mode == POWER_MGMT_MODE_IDLE)
+  {
+#if defined(CONFIG_PM_ENABLE) && CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(s_cpu_lock);
+#if defined(CONFIG_IDLE_LIGHT_SLEEP) && CONFIG_IDLE_LIGHT_SLEEP
+    esp_pm_lock_acquire(s_sleep_lock);
+#endif
+#endif
+    s_mode = POWER_MGMT_MODE_ACTIVE;
+    ESP_LOGI(TAG, "检测到输入活动,恢复全速");
+  }
+}
+
+power_mgmt_mode_t power_mgmt_get_mode(void)
+{
+  return s_mode;
+}
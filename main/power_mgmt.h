@@ -0,0 +1,67 @@
+/*
+ * Idle Power Management - 头文件
+ *
+ * 核心思想:
+ * - 输入空闲时整机仍全速空转: 累加器定时器已会停(见mouse_accumulator),
+ *   BLE参数已会放宽(见conn_params),但CPU频率和light-sleep没人管
+ * - 本模块补上最后一环: 活动期间持有pm锁保证全速,
+ *   空闲超时后释放锁,让DFS降频、(可选)自动light-sleep接管
+ * - 恢复走锁获取,第一条输入事件(idle->active迁移)立即回到全速,
+ *   不在每事件热路径上
+ *
+ * 注意: ESP32-S3的USB OTG host在light-sleep中会丢总线状态,唤醒后
+ * 设备重新枚举(约1秒)。因此light-sleep默认关闭,只降频;
+ * 电池部署按续航优先可打开CONFIG_IDLE_LIGHT_SLEEP
+ */
+
+#ifndef POWER_MGMT_H__
+#define POWER_MGMT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 空闲检测定时器周期(毫秒),与conn_params同节奏
+#define POWER_MGMT_IDLE_CHECK_MS 1000
+
+  /**
+   * @brief 电源状态机当前模式
+   */
+  typedef enum
+  {
+    POWER_MGMT_MODE_ACTIVE = 0, // 全速(持有pm锁)
+    POWER_MGMT_MODE_IDLE,       // 省电(锁已释放,DFS/light-sleep接管)
+  } power_mgmt_mode_t;
+
+  /**
+   * @brief 初始化电源管理(配置DFS,创建pm锁和空闲检测定时器)
+   *
+   * 需要sdkconfig启用CONFIG_PM_ENABLE,否则降级为no-op并告警
+   *
+   * @return ESP_OK 成功(含降级),其他值表示失败
+   */
+  esp_err_t power_mgmt_init(void);
+
+  /**
+   * @brief 输入活动通知(空闲->活动迁移时调用)
+   *
+   * 省电模式下立即重新持锁回到全速;
+   * 由mouse_accumulator的idle->active迁移触发,与conn_params同一挂点
+   */
+  void power_mgmt_notify_activity(void);
+
+  /**
+   * @brief 获取当前模式(心跳日志用)
+   */
+  power_mgmt_mode_t power_mgmt_get_mode(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_MGMT_H__ */
@@ -0,0 +1,112 @@
+/*
+ * HID报告缓冲池 - 实现文件
+ *
+ * 实现要点:
+ * - 槽位引用计数0表示空闲,acquire用compare_exchange 0->1抢占,
+ *   抢到即独占该槽,无需任何互斥锁
+ * - release用fetch_sub,减到0槽位自然回到空闲,不需要额外的空闲链表
+ * - 从上次分配位置开始环形扫描(s_next_hint),热路径上基本一次命中
+ */
+
+#include "report_pool.h"
+#include "hot_path.h"
+#include "esp_log.h"
+#include <stdatomic.h>
+
+static const char *TAG = "RPT_POOL";
+
+/* =================================================================================================
+   内部状态
+   ================================================================================================= */
+
+static report_buf_t s_bufs[REPORT_POOL_SLOTS];
+static atomic_int s_refcnt[REPORT_POOL_SLOTS];
+
+static atomic_uint s_next_hint = 0; // 环形扫描起点(仅为减少扫描,不要求精确)
+static atomic_uint s_total_acquired = 0;
+static atomic_uint s_total_exhausted = 0;
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+esp_err_t report_pool_init(void)
+{
+  for (int i = 0; i < REPORT_POOL_SLOTS; i++)
+  {
+    atomic_store(&s_refcnt[i], 0);
+  }
+  ESP_LOGI(TAG, "报告缓冲池已初始化: %d块 x %d字节", REPORT_POOL_SLOTS, REPORT_POOL_BUF_SIZE);
+  return ESP_OK;
+}
+
+report_buf_t *HOT_PATH_IRAM_ATTR report_pool_acquire(void)
+{
+  unsigned int start = atomic_load_explicit(&s_next_hint, memory_order_relaxed);
+  for (int n = 0; n < REPORT_POOL_SLOTS; n++)
+  {
+    int i = (start + n) % REPORT_POOL_SLOTS;
+    int expected = 0;
+    if (atomic_compare_exchange_strong_explicit(&s_refcnt[i], &expected, 1,
+                                                memory_order_acquire,
+                                                memory_order_relaxed))
+    {
+      atomic_store_explicit(&s_next_hint, (unsigned int)(i + 1), memory_order_relaxed);
+      atomic_fetch_add_explicit(&s_total_acquired, 1, memory_order_relaxed);
+      s_bufs[i].length = 0;
+      return &s_bufs[i];
+    }
+  }
+  atomic_fetch_add_explicit(&s_total_exhausted, 1, memory_order_relaxed);
+  return NULL;
+}
+
+void HOT_PATH_IRAM_ATTR report_pool_addref(report_buf_t *buf)
+{
+  if (buf == NULL)
+  {
+    return;
+  }
+  int i = (int)(buf - s_bufs);
+  atomic_fetch_add_explicit(&s_refcnt[i], 1, memory_order_relaxed);
+}
+
+void HOT_PATH_IRAM_ATTR report_pool_release(report_buf_t *buf)
+{
+  if (buf == NULL)
+  {
+    return;
+  }
+  int i = (int)(buf - s_bufs);
+  int prev = atomic_fetch_sub_explicit(&s_refcnt[i], 1, memory_order_release);
+  if (prev <= 0)
+  {
+    // 计数错配(多release)属于编程错误,记日志便于排查,不崩溃
+    ESP_LOGW(TAG, "槽位%d引用计数下溢(prev=%d)", i, prev);
+    atomic_store(&s_refcnt[i], 0);
+  }
+}
+
+void report_pool_get_stats(uint32_t *in_use, uint32_t *total_acquired, uint32_t *total_exhausted)
+{
+  if (in_use != NULL)
+  {
+    uint32_t count = 0;
+    for (int i = 0; i < REPORT_POOL_SLOTS; i++)
+    {
+      if (atomic_load_explicit(&s_refcnt[i], memory_order_relaxed) > 0)
+      {
+        count++;
+      }
+    }
+    *in_use = count;
+  }
+  if (total_acquired != NULL)
+  {
+    *total_acquired = atomic_load_explicit(&s_total_acquired, memory_order_relaxed);
+  }
+  if (total_exhausted != NULL)
+  {
+    *total_exhausted = atomic_load_explicit(&s_total_exhausted, memory_order_relaxed);
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * HID报告缓冲池 - 头文件
+ *
+ * 核心思想:
+ * - 固定数量的静态缓冲区+引用计数,1000Hz报告路径上零堆分配、零memcpy交接
+ * - USB接口回调acquire一块,原始报告直接读进去,下游阶段(解析/发送/异步转发)
+ *   需要跨回调持有时addref,用完release,计数归零即自动回收
+ * - 无锁: 每个槽位一个原子引用计数,acquire用CAS 0->1抢占空槽
+ * - 池耗尽时acquire返回NULL,调用方退回栈缓冲同步路径,不丢报告
+ */
+
+#ifndef REPORT_POOL_H__
+#define REPORT_POOL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 缓冲区数量: USB同一时刻最多一个在读 + 键盘队列深度内的在途报告
+#define REPORT_POOL_SLOTS 8
+
+// 单块容量: 与接口回调原有的64字节栈缓冲一致
+#define REPORT_POOL_BUF_SIZE 64
+
+  /**
+   * @brief 池化报告缓冲区
+   */
+  typedef struct
+  {
+    uint8_t data[REPORT_POOL_BUF_SIZE]; ///< 原始报告数据(USB层写一次)
+    uint16_t length;                    ///< 实际报告长度
+  } report_buf_t;
+
+  /**
+   * @brief 初始化缓冲池(全部槽位置空闲)
+   */
+  esp_err_t report_pool_init(void);
+
+  /**
+   * @brief 取一块空闲缓冲区(引用计数置1)
+   *
+   * 无锁,可在USB回调里调用
+   *
+   * @return 缓冲区指针; 池耗尽返回NULL(计入统计,调用方应走退化路径)
+   */
+  report_buf_t *report_pool_acquire(void);
+
+  /**
+   * @brief 增加引用(下游阶段要跨回调持有时调用)
+   */
+  void report_pool_addref(report_buf_t *buf);
+
+  /**
+   * @brief 释放引用,计数归零时槽位回到空闲
+   */
+  void report_pool_release(report_buf_t *buf);
+
+  /**
+   * @brief 获取统计信息(调试用,参数可为NULL)
+   *
+   * @param[out] in_use 当前占用槽位数
+   * @param[out] total_acquired 累计成功acquire次数
+   * @param[out] total_exhausted 累计池耗尽次数
+   */
+  void report_pool_get_stats(uint32_t *in_use, uint32_t *total_acquired, uint32_t *total_exhausted);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REPORT_POOL_H__ */
@@ -0,0 +1,186 @@
+/*
+ * USB报告解析工作任务 - 实现文件
+ *
+ * 核心逻辑:
+ * - HID Host驱动回调(producer)递交原始报告到无锁SPSC环并通知任务
+ * - 工作任务(consumer,优先级低于驱动任务)逐条调用
+ *   usb_hid_report_process()做布局查找/字段提取/入队
+ * - 报告数据优先零拷贝引用缓冲池,池耗尽时退回环内联拷贝槽
+ */
+
+#include "report_worker.h"
+#include "hid_host_example.h"
+#include "esp_log.h"
+#include "hot_path.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "REP_WORKER";
+
+// 任务参数: core 0与USB栈同核,优先级4低于HID驱动任务(5)、
+// 高于usb_lib_task(2),驱动一空闲就立刻开始解析
+#define REPORT_WORKER_TASK_PRIORITY 4
+#define REPORT_WORKER_TASK_STACK 4096
+#define REPORT_WORKER_TASK_CORE 0
+
+// 环条目: 池化缓冲引用或内联拷贝二选一(buf为NULL时用inline_data)
+typedef struct
+{
+  report_buf_t *buf;                       // 池化缓冲(工作任务release)
+  hid_host_device_handle_t device_handle;  // 来源设备
+  hid_host_dev_params_t dev_params;        // 回退路由用的设备参数
+  uint16_t length;                         // 报告字节数
+  uint8_t inline_data[REPORT_POOL_BUF_SIZE]; // 池耗尽时的拷贝槽
+} worker_entry_t;
+
+// 无锁SPSC环(与keyboard_queue同样的head/tail设计)
+typedef struct
+{
+  worker_entry_t entries[REPORT_WORKER_QUEUE_CAPACITY];
+  _Atomic uint32_t head; // 写入索引(仅生产者递增)
+  _Atomic uint32_t tail; // 读取索引(仅消费者递增)
+} worker_queue_t;
+
+static worker_queue_t g_queue = {
+    .head = 0,
+    .tail = 0};
+
+static TaskHandle_t s_worker_task = NULL;
+
+// 统计(processed/max_pending仅消费者写,dropped仅生产者写)
+static uint32_t s_total_processed = 0;
+static uint32_t s_total_dropped = 0;
+static uint32_t s_max_pending = 0;
+
+/* =================================================================================================
+   内部辅助函数
+   ================================================================================================= */
+
+static uint32_t HOT_PATH_IRAM_ATTR queue_count(void)
+{
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_acquire);
+  return head - tail;
+}
+
+// 工作任务主循环: 通知驱动,逐条排空后继续等待
+static void report_worker_task(void *arg)
+{
+  (void)arg;
+
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    uint32_t pending = queue_count();
+    if (pending > s_max_pending)
+    {
+      s_max_pending = pending;
+    }
+
+    while (queue_count() > 0)
+    {
+      uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_relaxed);
+      worker_entry_t *entry = &g_queue.entries[tail & REPORT_WORKER_QUEUE_MASK];
+
+      uint8_t *data = (entry->buf != NULL) ? entry->buf->data : entry->inline_data;
+      usb_hid_report_process(entry->device_handle, data, entry->length, &entry->dev_params);
+
+      if (entry->buf != NULL)
+      {
+        report_pool_release(entry->buf);
+        entry->buf = NULL;
+      }
+
+      atomic_store_explicit(&g_queue.tail, tail + 1, memory_order_release);
+      s_total_processed++;
+    }
+  }
+}
+
+/* =================================================================================================
+   公共API实现
+   ================================================================================================= */
+
+esp_err_t report_worker_init(void)
+{
+  BaseType_t created = xTaskCreatePinnedToCore(report_worker_task,
+                                               "rep_worker",
+                                               REPORT_WORKER_TASK_STACK,
+                                               NULL,
+                                               REPORT_WORKER_TASK_PRIORITY,
+                                               &s_worker_task,
+                                               REPORT_WORKER_TASK_CORE);
+  if (created != pdTRUE)
+  {
+    ESP_LOGE(TAG, "创建报告解析任务失败");
+    return ESP_ERR_NO_MEM;
+  }
+
+  ESP_LOGI(TAG, "报告解析任务已创建(core %d, 优先级%d, 环容量%d)",
+           REPORT_WORKER_TASK_CORE, REPORT_WORKER_TASK_PRIORITY, REPORT_WORKER_QUEUE_CAPACITY);
+  return ESP_OK;
+}
+
+bool HOT_PATH_IRAM_ATTR report_worker_submit(hid_host_device_handle_t hid_device_handle,
+                                             report_buf_t *buf,
+                                             const uint8_t *data,
+                                             size_t length,
+                                             const hid_host_dev_params_t *dev_params)
+{
+  if (s_worker_task == NULL || data == NULL || length > REPORT_POOL_BUF_SIZE)
+  {
+    return false;
+  }
+
+  uint32_t head = atomic_load_explicit(&g_queue.head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&g_queue.tail, memory_order_acquire);
+
+  if (head - tail >= REPORT_WORKER_QUEUE_CAPACITY)
+  {
+    // 环满说明工作任务严重积压(病态情况)。不退回调内同步解析:
+    // 下游各SPSC环的生产者必须唯一,丢弃一条并计数比交错push安全
+    s_total_dropped++;
+    return false;
+  }
+
+  worker_entry_t *entry = &g_queue.entries[head & REPORT_WORKER_QUEUE_MASK];
+  entry->device_handle = hid_device_handle;
+  entry->dev_params = *dev_params;
+  entry->length = (uint16_t)length;
+  entry->buf = buf;
+  if (buf != NULL)
+  {
+    // 零拷贝: 持有缓冲池引用,处理完在工作任务里release
+    report_pool_addref(buf);
+  }
+  else
+  {
+    memcpy(entry->inline_data, data, length);
+  }
+
+  atomic_store_explicit(&g_queue.head, head + 1, memory_order_release);
+
+  xTaskNotifyGive(s_worker_task);
+  return true;
+}
+
+void report_worker_get_stats(uint32_t *pending,
+                             uint32_t *total_processed,
+                             uint32_t *total_dropped,
+                             uint32_t *max_pending)
+{
+  if (pending)
+    *pending = queue_count();
+  if (total_processed)
+    *total_processed = s_total_processed;
+  if (total_dropped)
+    *total_dropped = s_total_dropped;
+  if (max_pending)
+  {
+    *max_pending = s_max_pending;
+    s_max_pending = 0;
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * USB报告解析工作任务 - 头文件
+ *
+ * 核心思想:
+ * - HID Host驱动任务(优先级5,core 0)的接口回调每处理一条报告,
+ *   驱动才会重新排队下一个中断IN传输;1000Hz鼠标只有1ms预算,
+ *   回调里做完整的布局查找/位提取/累加会在抖动下错过轮询
+ * - 回调现在只把原始报告读进池化缓冲并递交到本模块的SPSC环,
+ *   立即返回让驱动续排传输;解析在较低优先级的工作任务里进行
+ *   (缓冲池本身就是传输的double/triple buffering)
+ * - 工作任务优先级低于驱动任务: 下一个轮询完成时驱动随时可抢占,
+ *   先收包后解析,USB侧永不因解析而阻塞
+ */
+
+#ifndef REPORT_WORKER_H__
+#define REPORT_WORKER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "usb/hid_host.h"
+#include "report_pool.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 环容量: 大于缓冲池槽位数(8),池化报告全部在途时仍有拷贝槽可用
+#define REPORT_WORKER_QUEUE_CAPACITY 16
+#define REPORT_WORKER_QUEUE_MASK (REPORT_WORKER_QUEUE_CAPACITY - 1)
+
+  /**
+   * @brief 初始化工作任务(创建解析任务并固定到core 0)
+   */
+  esp_err_t report_worker_init(void);
+
+  /**
+   * @brief 递交一条原始输入报告给工作任务解析
+   *
+   * 仅在HID Host驱动任务(接口回调)里调用(SPSC生产者)。
+   * buf非NULL时引用计数加一,工作任务处理完负责release,
+   * 调用方照常release自己的引用;buf为NULL(池耗尽)时
+   * 把data拷贝进环内联缓冲,不依赖缓冲池。
+   *
+   * @param hid_device_handle 报告来源设备句柄
+   * @param buf 池化缓冲(data指向其内部时传入),池耗尽时为NULL
+   * @param data 原始报告数据
+   * @param length 报告字节数
+   * @param dev_params 设备参数(回退路由需要proto/sub_class)
+   * @return true 已入队; false 环满(报告被丢弃,计入统计)
+   */
+  bool report_worker_submit(hid_host_device_handle_t hid_device_handle,
+                            report_buf_t *buf,
+                            const uint8_t *data,
+                            size_t length,
+                            const hid_host_dev_params_t *dev_params);
+
+  /**
+   * @brief 获取统计信息(参数可为NULL)
+   *
+   * @param[out] pending 当前待解析报告数
+   * @param[out] total_processed 累计已解析报告数
+   * @param[out] total_dropped 累计因环满丢弃的报告数
+   * @param[out] max_pending 区间内的最大积压深度(读取后清零)
+   */
+  void report_worker_get_stats(uint32_t *pending,
+                               uint32_t *total_processed,
+                               uint32_t *total_dropped,
+                               uint32_t *max_pending);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REPORT_WORKER_H__ */